@@ -0,0 +1,238 @@
+#include <libchess/board.h>
+#include <libchess/game.h>
+#include <libchess/move_generator.h>
+#include <libchess/piece.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Usage: microbenchmarks [filter] [samples]. Times each hot path over a fixed
+// corpus of positions and prints nanoseconds per operation. Only benchmarks
+// whose name contains |filter| are run.
+namespace {
+const char *const corpus_fens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "8/8/1k6/2b5/2pP4/8/5K2/8 b - d3 0 1",
+    "2K2r2/4P3/8/8/8/8/8/3k4 w - - 0 1",
+    "rnb1kbnr/pppp1ppp/8/4p3/5PPq/8/PPPPP2P/RNBQKBNR w KQkq - 1 3",
+};
+
+// Untimed samples run first, to fill caches and let the clock speed settle.
+constexpr int warmup_samples = 3;
+// Each sample repeats its benchmark for at least this long, so the clock's
+// resolution doesn't show in the result.
+constexpr auto min_sample_time = std::chrono::microseconds(2000);
+
+std::vector<chess::Board> corpus;
+// Everything a benchmark computes is added here and printed at the end, so
+// the compiler can't drop the work as unused.
+uint64_t sink = 0;
+
+// Times |body|, which does one pass over the corpus and returns how many
+// operations it did, and prints the median and 10th and 90th percentile
+// nanoseconds per operation over |samples| samples.
+template <typename Body>
+void run(std::string_view filter, int samples, const char *name, Body body) {
+  if (std::string_view(name).find(filter) == std::string_view::npos) {
+    return;
+  }
+
+  // Passes per sample, doubled until one sample takes long enough.
+  int passes = 1;
+  uint64_t operations = 0;
+  for (;;) {
+    operations = 0;
+    const auto start_time = std::chrono::steady_clock::now();
+    for (auto i = 0; i < passes; i++) {
+      operations += body();
+    }
+    if (std::chrono::steady_clock::now() - start_time >= min_sample_time) {
+      break;
+    }
+    passes *= 2;
+  }
+
+  std::vector<double> times;
+  for (auto sample = 0; sample < warmup_samples + samples; sample++) {
+    const auto start_time = std::chrono::steady_clock::now();
+    for (auto i = 0; i < passes; i++) {
+      body();
+    }
+    const std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start_time;
+    if (sample >= warmup_samples) {
+      times.push_back(elapsed.count() / operations);
+    }
+  }
+
+  std::sort(times.begin(), times.end());
+  const auto percentile = [&](int percent) {
+    return times[(times.size() - 1) * percent / 100];
+  };
+  std::cout << std::left << std::setw(28) << name << std::right << std::fixed
+            << std::setprecision(2) << std::setw(10) << percentile(50)
+            << std::setw(10) << percentile(10) << std::setw(10)
+            << percentile(90) << std::endl;
+}
+
+// Applies |attacks| from every square of every corpus board's occupancy.
+template <typename Attacks> uint64_t attack_pass(Attacks attacks) {
+  for (const auto &board : corpus) {
+    for (auto square = 0; square < 64; square++) {
+      sink += attacks(board.occupied(), chess::Square(square)).data();
+    }
+  }
+  return corpus.size() * 64;
+}
+
+template <chess::GenerationMode mode> uint64_t generate_pass() {
+  chess::MoveGenerator generator;
+  uint64_t operations = 0;
+  for (const auto &board : corpus) {
+    // Evasions are only defined in check.
+    if (mode == chess::kEvasions && !board.check(board.turn())) {
+      continue;
+    }
+    sink += generator.generate<mode>(board).size();
+    operations++;
+  }
+  return operations;
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  const std::string_view filter = argc > 1 ? argv[1] : "";
+  const int samples = argc > 2 ? std::max(1, atoi(argv[2])) : 25;
+
+  for (auto fen : corpus_fens) {
+    corpus.push_back(chess::Board::from_fen(fen));
+  }
+
+  std::vector<chess::Game> games(corpus.begin(), corpus.end());
+  std::vector<chess::MoveList> legal_moves;
+  std::vector<std::string> fens;
+  chess::MoveGenerator generator;
+  for (const auto &board : corpus) {
+    legal_moves.push_back(generator.generate_legal_moves(board));
+    fens.push_back(board.fen());
+  }
+
+  std::cout << std::left << std::setw(28) << "ns/op" << std::right
+            << std::setw(10) << "median" << std::setw(10) << "p10"
+            << std::setw(10) << "p90" << std::endl;
+
+  run(filter, samples, "pawn_attack_board", [] {
+    return attack_pass([](chess::Bitboard, chess::Square square) {
+      return chess::pawn_attack_board(chess::kSideWhite, square);
+    });
+  });
+  run(filter, samples, "knight_attack_board", [] {
+    return attack_pass([](chess::Bitboard, chess::Square square) {
+      return chess::knight_attack_board(square);
+    });
+  });
+  run(filter, samples, "bishop_attack_board", [] {
+    return attack_pass([](chess::Bitboard occupied, chess::Square square) {
+      return chess::bishop_attack_board(occupied, square);
+    });
+  });
+  run(filter, samples, "rook_attack_board", [] {
+    return attack_pass([](chess::Bitboard occupied, chess::Square square) {
+      return chess::rook_attack_board(occupied, square);
+    });
+  });
+  run(filter, samples, "queen_attack_board", [] {
+    return attack_pass([](chess::Bitboard occupied, chess::Square square) {
+      return chess::queen_attack_board(occupied, square);
+    });
+  });
+  run(filter, samples, "king_attack_board", [] {
+    return attack_pass([](chess::Bitboard, chess::Square square) {
+      return chess::king_attack_board(square);
+    });
+  });
+
+  run(filter, samples, "attacks_to_square", [] {
+    for (const auto &board : corpus) {
+      for (auto square = 0; square < 64; square++) {
+        sink += board.attacks_to_square(board.turn(), chess::Square(square));
+      }
+    }
+    return corpus.size() * 64;
+  });
+  run(filter, samples, "check", [] {
+    for (const auto &board : corpus) {
+      sink += board.check(chess::kSideWhite) + board.check(chess::kSideBlack);
+    }
+    return corpus.size() * 2;
+  });
+
+  run(filter, samples, "make_move+unmake_move", [&] {
+    uint64_t operations = 0;
+    for (size_t i = 0; i < games.size(); i++) {
+      for (const auto move : legal_moves[i]) {
+        games[i].make_move(move);
+        sink += games[i].board().key();
+        games[i].unmake_move();
+      }
+      operations += legal_moves[i].size();
+    }
+    return operations;
+  });
+  run(filter, samples, "Board::after", [&] {
+    uint64_t operations = 0;
+    for (size_t i = 0; i < corpus.size(); i++) {
+      for (const auto move : legal_moves[i]) {
+        sink += corpus[i].after(move).key();
+      }
+      operations += legal_moves[i].size();
+    }
+    return operations;
+  });
+
+  run(filter, samples, "from_fen", [&] {
+    for (const auto &fen : fens) {
+      sink += chess::Board::from_fen(fen).key();
+    }
+    return fens.size();
+  });
+  run(filter, samples, "fen", [] {
+    for (const auto &board : corpus) {
+      sink += board.fen().size();
+    }
+    return corpus.size();
+  });
+
+  run(filter, samples, "generate<kCaptures>",
+      generate_pass<chess::kCaptures>);
+  run(filter, samples, "generate<kQuiets>", generate_pass<chess::kQuiets>);
+  run(filter, samples, "generate<kEvasions>",
+      generate_pass<chess::kEvasions>);
+  run(filter, samples, "generate<kQuietChecks>",
+      generate_pass<chess::kQuietChecks>);
+  run(filter, samples, "generate<kLegal>", generate_pass<chess::kLegal>);
+  run(filter, samples, "generate<kPseudolegal>",
+      generate_pass<chess::kPseudolegal>);
+  run(filter, samples, "count_legal_moves", [] {
+    chess::MoveGenerator generator;
+    for (const auto &board : corpus) {
+      sink += generator.count_legal_moves(board);
+    }
+    return corpus.size();
+  });
+
+  std::cout << "Checksum: " << sink << std::endl;
+  return 0;
+}
@@ -1,31 +1,289 @@
-#include <libchess/game.h>
-#include <libchess/move_generator.h>
-#include <iostream>
-
-int perft(chess::Game& game, int depth) {
-	if (depth == 0) {
-		return 1;
-	}
-
-	chess::MoveGenerator move_generator;
-	chess::MoveList moves = move_generator.generate_legal_moves(game);
-	int count = 0;	
-
-	for (auto i = 0; i < moves.size(); i++) {
-		auto move = moves.moves()[i];
-		auto new_game = game;
-		new_game.make_move(move);
-		count += perft(new_game, depth - 1);
-		new_game.unmake_move();
-	}
-
-	return count;
-}
-
-int main() {
-	constexpr int depth = 3;
-
-	chess::Game game;
-	auto count = perft(game, depth);
-	std::cout << "Count: " << count << std::endl;
-}
\ No newline at end of file
+#include <libchess/board.h>
+#include <libchess/perft.h>
+#include <stdint.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+const char usage[] =
+    "Usage: perft [options] [EPD file]\n"
+    "Counts every position in the file to the depths given by its \"Dn count\"\n"
+    "operations, and checks the counts. Without a file, counts the starting\n"
+    "position to depth 6.\n"
+    "  --fen FEN      Count FEN instead of a file\n"
+    "  --depth N      Count no deeper than N, or to exactly N with --fen\n"
+    "  --threads N    Threads to count with, default one per core\n"
+    "  --hash MB      Share a cache of MB megabytes between counts\n"
+    "  --divide       Also count below each root move\n"
+    "  --json         Report as JSON instead of text\n";
+
+// A depth to count a position to. |expected| is 0 if unknown.
+struct Target {
+	int depth;
+	uint64_t expected;
+};
+
+struct Position {
+	chess::Board board;
+	std::vector<Target> targets;
+};
+
+struct Result {
+	int depth;
+	uint64_t nodes;
+	uint64_t expected;
+	double seconds;
+	std::vector<chess::PerftDivision> divisions;
+
+	bool ok() const { return !expected || nodes == expected; }
+};
+
+uint64_t nodes_per_second(uint64_t nodes, double seconds) {
+	return seconds > 0 ? static_cast<uint64_t>(nodes / seconds) : 0;
+}
+
+std::string_view trim(std::string_view text) {
+	while (!text.empty() && strchr(" \t\r", text.front())) {
+		text.remove_prefix(1);
+	}
+	while (!text.empty() && strchr(" \t\r", text.back())) {
+		text.remove_suffix(1);
+	}
+	return text;
+}
+
+// Parses EPD operations such as ";D1 20 ;D2 400" into |targets|, ignoring
+// any other operation. Returns false if a depth operation is malformed.
+bool parse_targets(std::string_view operations, std::vector<Target> *targets) {
+	while (!operations.empty()) {
+		const auto end = operations.find(';');
+		const auto operation = trim(operations.substr(0, end));
+		operations.remove_prefix(end == std::string_view::npos
+		                             ? operations.size() : end + 1);
+		if (operation.empty() || operation.front() != 'D') {
+			continue;
+		}
+
+		char *depth_end;
+		char *count_end;
+		const std::string text(operation.substr(1));
+		const auto depth = strtol(text.c_str(), &depth_end, 10);
+		const auto count = strtoull(depth_end, &count_end, 10);
+		if (depth_end == text.c_str() || *depth_end != ' ' || *count_end ||
+		    depth < 1 || depth > 64 || count == 0) {
+			return false;
+		}
+		targets->push_back({static_cast<int>(depth), count});
+	}
+
+	return true;
+}
+
+// Reads the positions of an EPD file, skipping blank lines and comments.
+bool read_positions(const char *path, std::vector<Position> *positions) {
+	std::ifstream file(path);
+	if (!file) {
+		std::cerr << "Can't open " << path << std::endl;
+		return false;
+	}
+
+	std::string line;
+	for (auto line_number = 1; std::getline(file, line); line_number++) {
+		const auto text = trim(line);
+		if (text.empty() || text.front() == '#') {
+			continue;
+		}
+
+		Position position;
+		std::string_view operations;
+		if (chess::Board::parse_fen(text, &position.board, &operations) !=
+		        chess::kFenOk ||
+		    !parse_targets(trim(operations), &position.targets)) {
+			std::cerr << path << ":" << line_number << ": Bad EPD line"
+			          << std::endl;
+			return false;
+		}
+		positions->push_back(position);
+	}
+
+	return true;
+}
+
+std::string uci(chess::Move move) {
+	char buffer[6];
+	move.write_uci(buffer);
+	return buffer;
+}
+
+void print_text(const chess::Board &board,
+                const std::vector<Result> &results) {
+	std::cout << board.fen() << std::endl;
+	for (const auto &result : results) {
+		for (const auto &division : result.divisions) {
+			std::cout << "    " << uci(division.move) << ": " << division.nodes
+			          << std::endl;
+		}
+		std::cout << "  Depth " << result.depth << ": " << result.nodes
+		          << " nodes, " << result.seconds << "s, "
+		          << nodes_per_second(result.nodes, result.seconds) << " nps";
+		if (!result.ok()) {
+			std::cout << ", FAILED, expected " << result.expected;
+		}
+		std::cout << std::endl;
+	}
+}
+
+void print_json(const chess::Board &board, const std::vector<Result> &results,
+                bool first) {
+	std::cout << (first ? "\n" : ",\n") << "    {\"fen\": \"" << board.fen()
+	          << "\", \"results\": [";
+	for (size_t i = 0; i < results.size(); i++) {
+		const auto &result = results[i];
+		std::cout << (i ? ",\n" : "\n") << "      {\"depth\": " << result.depth
+		          << ", \"nodes\": " << result.nodes << ", \"expected\": ";
+		if (result.expected) {
+			std::cout << result.expected;
+		} else {
+			std::cout << "null";
+		}
+		std::cout << ", \"ok\": " << (result.ok() ? "true" : "false")
+		          << ", \"seconds\": " << result.seconds << ", \"nps\": "
+		          << nodes_per_second(result.nodes, result.seconds);
+		if (!result.divisions.empty()) {
+			std::cout << ", \"divide\": {";
+			for (size_t j = 0; j < result.divisions.size(); j++) {
+				std::cout << (j ? ", \"" : "\"")
+				          << uci(result.divisions[j].move)
+				          << "\": " << result.divisions[j].nodes;
+			}
+			std::cout << "}";
+		}
+		std::cout << "}";
+	}
+	std::cout << "]}";
+}
+} // namespace
+
+// Exits with 1 if any count differs from the expected one, and 2 on bad
+// arguments or input.
+int main(int argc, char **argv) {
+	const char *path = nullptr;
+	const char *fen = nullptr;
+	int max_depth = 0;
+	int threads = 0;
+	int hash_megabytes = 0;
+	bool divide = false;
+	bool json = false;
+	for (auto i = 1; i < argc; i++) {
+		const std::string_view arg = argv[i];
+		const auto has_value = i + 1 < argc;
+		if (arg == "--fen" && has_value) {
+			fen = argv[++i];
+		} else if (arg == "--depth" && has_value) {
+			max_depth = atoi(argv[++i]);
+		} else if (arg == "--threads" && has_value) {
+			threads = atoi(argv[++i]);
+		} else if (arg == "--hash" && has_value) {
+			hash_megabytes = atoi(argv[++i]);
+		} else if (arg == "--divide") {
+			divide = true;
+		} else if (arg == "--json") {
+			json = true;
+		} else if (arg.substr(0, 1) != "-" && !path) {
+			path = argv[i];
+		} else {
+			std::cerr << usage;
+			return 2;
+		}
+	}
+
+	std::vector<Position> positions;
+	if (path && !fen) {
+		if (!read_positions(path, &positions)) {
+			return 2;
+		}
+		if (max_depth > 0) {
+			for (auto &position : positions) {
+				auto &targets = position.targets;
+				for (auto it = targets.begin(); it != targets.end();) {
+					it = it->depth > max_depth ? targets.erase(it) : it + 1;
+				}
+			}
+		}
+	} else {
+		Position position;
+		if (chess::Board::parse_fen(
+		        fen ? fen
+		            : "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+		        &position.board) != chess::kFenOk ||
+		    path) {
+			std::cerr << usage;
+			return 2;
+		}
+		position.targets.push_back({max_depth > 0 ? max_depth : 6, 0});
+		positions.push_back(position);
+	}
+
+	std::unique_ptr<chess::PerftCache> cache;
+	if (hash_megabytes > 0) {
+		cache = std::make_unique<chess::PerftCache>(hash_megabytes);
+	}
+
+	uint64_t total_nodes = 0;
+	double total_seconds = 0;
+	int failures = 0;
+	if (json) {
+		std::cout << "{\n  \"positions\": [";
+	}
+	for (size_t i = 0; i < positions.size(); i++) {
+		const auto &position = positions[i];
+		std::vector<Result> results;
+		for (const auto &target : position.targets) {
+			Result result = {target.depth, 0, target.expected, 0, {}};
+			const auto start_time = std::chrono::steady_clock::now();
+			if (divide) {
+				result.divisions = chess::perft_divide(
+				    position.board, target.depth, threads, cache.get());
+				for (const auto &division : result.divisions) {
+					result.nodes += division.nodes;
+				}
+			} else {
+				result.nodes = chess::parallel_perft(
+				    position.board, target.depth, threads, cache.get());
+			}
+			result.seconds = std::chrono::duration<double>(
+			    std::chrono::steady_clock::now() - start_time).count();
+
+			total_nodes += result.nodes;
+			total_seconds += result.seconds;
+			failures += !result.ok();
+			results.push_back(result);
+		}
+
+		if (json) {
+			print_json(position.board, results, i == 0);
+		} else {
+			print_text(position.board, results);
+		}
+	}
+
+	const auto nps = nodes_per_second(total_nodes, total_seconds);
+	if (json) {
+		std::cout << "\n  ],\n  \"nodes\": " << total_nodes
+		          << ",\n  \"seconds\": " << total_seconds
+		          << ",\n  \"nps\": " << nps << ",\n  \"failures\": "
+		          << failures << "\n}" << std::endl;
+	} else {
+		std::cout << "Total: " << total_nodes << " nodes, " << total_seconds
+		          << "s, " << nps << " nps, " << failures << " failed"
+		          << std::endl;
+	}
+	return failures ? 1 : 0;
+}
@@ -1,153 +1,285 @@
-#pragma once
-
-#include <stdint.h>
-
-#include <string>
-#include <vector>
-
-#include "bitboard.h"
-#include "square.h"
-
-namespace chess {
-enum Side {
-  kSideWhite = 0,
-  kSideBlack = 1,
-  kNumSides,
-};
-
-enum CastlingRights {
-  kCastleWhiteKingSide = 0,
-  kCastleWhiteQueenSide = 1,
-  kCastleBlackKingSide = 2,
-  kCastleBlackQueenSide = 3,
-  kNumCastle,
-};
-
-enum PieceType {
-  kPiecePawn = 0,
-  kPieceKnight = 1,
-  kPieceBishop = 2,
-  kPieceRook = 3,
-  kPieceQueen = 4,
-  kPieceKing = 5,
-  kNumPieces,
-};
-
-class Board {
-public:
-  Board(std::vector<Bitboard> pawns, std::vector<Bitboard> knights,
-        std::vector<Bitboard> bishops, std::vector<Bitboard> rooks,
-        std::vector<Bitboard> queens, std::vector<Bitboard> kings,
-        std::vector<bool> castling, int side, Square ep_square, int half_move,
-        int full_move);
-  static Board from_fen(std::string fen);
-  bool operator==(const Board &board) const;
-  bool operator!=(const Board &board) const { return !(*this == board); };
-
-  std::string fen() const;
-
-  const Bitboard &pawns(int side) const { return pieces_[side][kPiecePawn]; }
-  const Bitboard &knights(int side) const {
-    return pieces_[side][kPieceKnight];
-  }
-  const Bitboard &bishops(int side) const {
-    return pieces_[side][kPieceBishop];
-  }
-  const Bitboard &rooks(int side) const { return pieces_[side][kPieceRook]; }
-  const Bitboard &queens(int side) const { return pieces_[side][kPieceQueen]; }
-  const Bitboard &kings(int side) const { return pieces_[side][kPieceKing]; }
-  const Bitboard &pawns() const { return pawns(side_); }
-  const Bitboard &knights() const { return knights(side_); }
-  const Bitboard &bishops() const { return bishops(side_); }
-  const Bitboard &rooks() const { return rooks(side_); }
-  const Bitboard &queens() const { return queens(side_); }
-  const Bitboard &kings() const { return kings(side_); }
-
-  const Bitboard &piece_board(int side, int piece_type) const {
-    return pieces_[side][piece_type];
-  }
-  void set_piece_board(int side, int piece_type, Bitboard board) {
-    pieces_[side][piece_type] = board;
-  }
-  int piece_type_at(int side, Square square) const {
-    if (!square_occupied(square))
-      return -1;
-
-    for (auto i = 0; i < kNumPieces; i++) {
-      auto &piece_board = pieces_[side][i];
-      if (piece_board.occupied(square))
-        return i;
-    }
-
-    return -1;
-  }
-  int piece_type_at(Square square) const {
-    auto piece = piece_type_at(kSideWhite, square);
-    if (piece == -1) {
-      piece = piece_type_at(kSideBlack, square);
-    }
-
-    return piece;
-  }
-
-  const Bitboard &occupied(int side) const { return occupied_[side]; }
-  const Bitboard occupied() const {
-    return occupied_[kSideWhite] | occupied_[kSideBlack];
-  }
-  void update_occupied() {
-    for (int side = 0; side < kNumSides; side++) {
-      occupied_[side] = 0;
-
-      for (int piece = 0; piece < kNumPieces; piece++) {
-        occupied_[side] |= piece_board(side, piece);
-      }
-    }
-  }
-
-  bool castling(int castle_side) const { return castling_[castle_side]; }
-  void set_castling(int castle_side, bool value) {
-    castling_[castle_side] = value;
-  }
-
-  int turn() const { return side_; };
-  void set_turn(int side) { side_ = side; }
-
-  Square ep_square() const { return ep_square_; };
-  void set_ep_square(Square ep_square) { ep_square_ = ep_square; }
-
-  int half_move() const { return half_move_; };
-  void set_half_move(int half_move) { half_move_ = half_move; }
-
-  int full_move() const { return full_move_; };
-  void set_full_move(int full_move) { full_move_ = full_move; }
-
-  bool square_occupied(int side, Square square) const {
-    return this->occupied_[side].occupied(square);
-  };
-
-  bool square_occupied(Square square) const {
-    return square_occupied(kSideWhite, square) ||
-           square_occupied(kSideBlack, square);
-  };
-
-  uint64_t attacks_to_square(int side, Square square) const;
-  bool check(int side) const;
-
-private:
-  // Bitboards representing each side's pieces.
-  Bitboard pieces_[kNumSides][kNumPieces];
-  Bitboard occupied_[kNumSides];
-  // Castling rights per side and per side of the board (king side and queen
-  // side)
-  bool castling_[kNumCastle];
-  // The side to play. 0 = white, 1 = black.
-  int side_;
-  int half_move_;
-  int full_move_;
-  // Square for en passant captures. -1 if no en passant capture is possible
-  // this turn.
-  Square ep_square_;
-};
-
-extern Board null_board;
-} // namespace chess
\ No newline at end of file
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+
+#include "bitboard.h"
+#include "piece.h"
+#include "square.h"
+
+namespace chess {
+enum Side {
+  kSideWhite = 0,
+  kSideBlack = 1,
+  kNumSides,
+};
+
+enum CastlingRights {
+  kCastleWhiteKingSide = 0,
+  kCastleWhiteQueenSide = 1,
+  kCastleBlackKingSide = 2,
+  kCastleBlackQueenSide = 3,
+  kNumCastle,
+};
+
+enum PieceType {
+  kPiecePawn = 0,
+  kPieceKnight = 1,
+  kPieceBishop = 2,
+  kPieceRook = 3,
+  kPieceQueen = 4,
+  kPieceKing = 5,
+  kNumPieces,
+};
+
+// Result of parsing a FEN string. Each error names the field that failed.
+enum FenError {
+  kFenOk = 0,
+  kFenEmpty = 1,
+  kFenBadPlacement = 2,
+  kFenBadSide = 3,
+  kFenBadCastling = 4,
+  kFenBadEnPassant = 5,
+  kFenBadClock = 6,
+};
+
+// Rook squares before and after castling, indexed by CastlingRights value.
+// Shared by Board::make_move() and Game::unmake_move().
+constexpr Square castling_rook_from[kNumCastle] = {
+    Square(7, 0), Square(0, 0), Square(7, 7), Square(0, 7)};
+constexpr Square castling_rook_to[kNumCastle] = {Square(5, 0), Square(3, 0),
+                                                 Square(5, 7), Square(3, 7)};
+
+// Longest FEN Board::write_fen() can produce, without the terminating null:
+// eight full ranks and separators, then every field at its widest.
+constexpr size_t max_fen_length = 71 + 22;
+
+// Random keys XORed together into a position's Zobrist key, one for every
+// piece on every square, black to move, each castling right and each en
+// passant file. Defined in board.cc and generated at compile time.
+struct ZobristKeys {
+  uint64_t pieces[kNumSides][kNumPieces][64];
+  uint64_t side;
+  uint64_t castling[kNumCastle];
+  uint64_t ep_file[8];
+};
+extern const ZobristKeys zobrist_keys;
+
+class Move;
+
+class Board {
+public:
+  // An empty board with white to move and no castling rights.
+  Board();
+  // |castling| holds one bit per CastlingRights value.
+  Board(const Bitboard (&pieces)[kNumSides][kNumPieces], uint8_t castling,
+        int side, Square ep_square, int half_move, int full_move);
+  // Parses |fen| in a single pass without allocating. Also accepts EPD lines,
+  // whose clocks default to 0 and 1. Whatever follows the position, such as
+  // EPD operations, is stored in |rest| if given. |board| is left untouched on
+  // error.
+  static FenError parse_fen(std::string_view fen, Board *board,
+                            std::string_view *rest = nullptr);
+  // Parses newline separated FEN or EPD lines from |buffer| into |boards|,
+  // skipping blank lines, until |capacity| boards are filled. Stops at the
+  // first line that fails, storing its error in |error|. Returns the number
+  // of boards parsed.
+  static size_t parse_fens(std::string_view buffer, Board *boards,
+                           size_t capacity, FenError *error);
+  // Like parse_fen(), but returns null_board on error.
+  static Board from_fen(std::string_view fen);
+  bool operator==(const Board &board) const;
+  bool operator!=(const Board &board) const { return !(*this == board); };
+
+  std::string fen() const;
+  // Writes the FEN of the position and a terminating null to |out|, which
+  // must hold at least max_fen_length + 1 characters. Returns the length
+  // written, not counting the null.
+  size_t write_fen(char *out) const;
+
+  // Plays |move|, which must be legal here, and returns the type of the piece
+  // it captured, -1 if none. Game::make_move() keeps what's needed to take
+  // it back.
+  int make_move(const Move move);
+  // A copy of the board with |move| played, for callers that don't need to
+  // take moves back.
+  Board after(const Move move) const;
+
+  Bitboard pawns(int side) const { return piece_board(side, kPiecePawn); }
+  Bitboard knights(int side) const { return piece_board(side, kPieceKnight); }
+  Bitboard bishops(int side) const { return piece_board(side, kPieceBishop); }
+  Bitboard rooks(int side) const { return piece_board(side, kPieceRook); }
+  Bitboard queens(int side) const { return piece_board(side, kPieceQueen); }
+  Bitboard kings(int side) const { return piece_board(side, kPieceKing); }
+  Bitboard pawns() const { return pawns(side_); }
+  Bitboard knights() const { return knights(side_); }
+  Bitboard bishops() const { return bishops(side_); }
+  Bitboard rooks() const { return rooks(side_); }
+  Bitboard queens() const { return queens(side_); }
+  Bitboard kings() const { return kings(side_); }
+
+  // Pieces of a type regardless of side.
+  const Bitboard &piece_board(int piece_type) const {
+    return pieces_[piece_type];
+  }
+  Bitboard piece_board(int side, int piece_type) const {
+    return pieces_[piece_type] & sides_[side];
+  }
+  void set_piece_board(int side, int piece_type, Bitboard board);
+  // Adds, removes or moves a single piece, keeping occupancy, the piece
+  // mailbox and the key in sync. Each is one XOR on the piece's type and side
+  // boards, so |square| must be empty when putting and hold the piece when
+  // removing or moving it.
+  void put_piece(int side, int piece_type, Square square) {
+    toggle_piece(side, piece_type, Bitboard(1ull << square.index()));
+    piece_on_[square.index()] = piece_type;
+    key_ ^= zobrist_keys.pieces[side][piece_type][square.index()];
+  }
+  void remove_piece(int side, int piece_type, Square square) {
+    toggle_piece(side, piece_type, Bitboard(1ull << square.index()));
+    piece_on_[square.index()] = -1;
+    key_ ^= zobrist_keys.pieces[side][piece_type][square.index()];
+  }
+  void move_piece(int side, int piece_type, Square from, Square to) {
+    toggle_piece(side, piece_type,
+                 Bitboard(1ull << from.index() | 1ull << to.index()));
+    piece_on_[from.index()] = -1;
+    piece_on_[to.index()] = piece_type;
+    key_ ^= zobrist_keys.pieces[side][piece_type][from.index()] ^
+            zobrist_keys.pieces[side][piece_type][to.index()];
+  }
+  int piece_type_at(int side, Square square) const {
+    if (!sides_[side].occupied(square))
+      return -1;
+
+    return piece_on_[square.index()];
+  }
+  int piece_type_at(Square square) const { return piece_on_[square.index()]; }
+
+  const Bitboard &occupied(int side) const { return sides_[side]; }
+  Bitboard occupied() const { return sides_[kSideWhite] | sides_[kSideBlack]; }
+
+  bool castling(int castle_side) const {
+    return (castling_ >> castle_side) & 1;
+  }
+  void set_castling(int castle_side, bool value) {
+    set_castling_rights((castling_ & ~(1 << castle_side)) |
+                        (value << castle_side));
+  }
+  // Every castling right as a mask, one bit per CastlingRights value.
+  uint8_t castling_rights() const { return castling_; }
+  void set_castling_rights(uint8_t rights) {
+    for (auto changed = castling_ ^ rights; changed; changed &= changed - 1) {
+      key_ ^= zobrist_keys.castling[platform::find_first_set(changed)];
+    }
+    castling_ = rights;
+  }
+
+  int turn() const { return side_; };
+  void set_turn(int side) {
+    if (side_ != side) {
+      key_ ^= zobrist_keys.side;
+    }
+    side_ = side;
+  }
+
+  Square ep_square() const { return ep_square_; };
+  void set_ep_square(Square ep_square) {
+    if (ep_square_ != null_square) {
+      key_ ^= zobrist_keys.ep_file[ep_square_.file()];
+    }
+    if (ep_square != null_square) {
+      key_ ^= zobrist_keys.ep_file[ep_square.file()];
+    }
+    ep_square_ = ep_square;
+  }
+
+  int half_move() const { return half_move_; };
+  void set_half_move(int half_move) { half_move_ = half_move; }
+
+  int full_move() const { return full_move_; };
+  void set_full_move(int full_move) { full_move_ = full_move; }
+
+  bool square_occupied(int side, Square square) const {
+    return sides_[side].occupied(square);
+  };
+
+  bool square_occupied(Square square) const {
+    return occupied().occupied(square);
+  };
+
+  // Zobrist key of the position. Kept up to date by every setter above, so
+  // make_move only pays a few XORs for it.
+  uint64_t key() const { return key_; }
+  // Computes the key from scratch.
+  uint64_t compute_key() const;
+
+  // Pieces of either side attacking |square|, with sliders blocked by
+  // |occupied|. Works backwards from the square, looking it up in each
+  // piece's attack table and keeping the pieces found there.
+  Bitboard attackers_to(Square square, Bitboard occupied) const {
+    const auto diagonal = pieces_[kPieceBishop] | pieces_[kPieceQueen];
+    const auto straight = pieces_[kPieceRook] | pieces_[kPieceQueen];
+
+    return (pawn_attack_board(kSideBlack, square) &
+            piece_board(kSideWhite, kPiecePawn)) |
+           (pawn_attack_board(kSideWhite, square) &
+            piece_board(kSideBlack, kPiecePawn)) |
+           (knight_attack_board(square) & pieces_[kPieceKnight]) |
+           (bishop_attack_board(occupied, square) & diagonal) |
+           (rook_attack_board(occupied, square) & straight) |
+           (king_attack_board(square) & pieces_[kPieceKing]);
+  }
+  Bitboard attackers_to(Square square) const {
+    return attackers_to(square, occupied());
+  }
+
+  // Every square attacked by |side|'s pieces.
+  Bitboard attacked_squares(int side) const;
+  uint64_t attacks_to_square(int side, Square square) const {
+    return (attackers_to(square) & sides_[side]).data();
+  }
+  bool check(int side) const {
+    const auto &kings = this->kings(side);
+    return kings.data() &&
+           attacks_to_square(!side, Square(kings.find_first()));
+  }
+
+private:
+  // make_move() specialized on the side to move, so that directions, ranks
+  // and castling squares fold into constants.
+  template <Side side> int make_move(const Move move);
+  void toggle_piece(int side, int piece_type, Bitboard squares) {
+    pieces_[piece_type] ^= squares;
+    sides_[side] ^= squares;
+  }
+
+  // Pieces of each type and of each side. A side's pieces of one type are
+  // the intersection of the two. Together they fill one cache line.
+  Bitboard pieces_[kNumPieces];
+  Bitboard sides_[kNumSides];
+  // Type of the piece on each square, -1 if empty. Mirrors the bitboards so
+  // piece lookups don't have to scan them.
+  int8_t piece_on_[64];
+  uint64_t key_;
+  // Clocks are kept narrow. 65535 moves is far beyond any real game.
+  uint16_t half_move_;
+  uint16_t full_move_;
+  // Castling rights, one bit per CastlingRights value.
+  uint8_t castling_;
+  // The side to play. 0 = white, 1 = black.
+  uint8_t side_;
+  // Square for en passant captures. null_square if no en passant capture is
+  // possible this turn.
+  Square ep_square_;
+};
+
+static_assert(sizeof(Board) == 144 && alignof(Board) == 8,
+              "Board should stay two cache lines of bitboards and mailbox "
+              "plus 16 bytes of state");
+
+extern Board null_board;
+} // namespace chess
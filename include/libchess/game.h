@@ -1,35 +1,52 @@
-#pragma once
-
-#include <vector>
-
-#include "board.h"
-#include "move.h"
-
-namespace chess {
-class Game {
-public:
-  Game() : Game(default_fen) {}
-  Game(const Board &board) : board_(board) {}
-  Game(const std::string &fen) : board_(Board::from_fen(fen)) {}
-
-  void make_move(const Move move);
-  void make_null_move();
-  void unmake_move();
-
-  const Board &board() const { return board_; }
-
-  bool drawn() const;
-
-private:
-  bool is_stalemate() const;
-  bool is_fifty_move() const;
-  bool is_repetition() const;
-
-  inline static const std::string default_fen =
-      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
-  // The current board state, reflecting the last move's effect.
-  Board board_;
-  // Past board states.
-  std::vector<Board> old_boards_;
-};
-} // namespace chess
\ No newline at end of file
+#pragma once
+
+#include <vector>
+
+#include "board.h"
+#include "move.h"
+
+namespace chess {
+// Undo record for a single move. Holds only what can't be recovered from the
+// move and the board after it.
+struct StateInfo {
+  // Zobrist key of the position before the move.
+  uint64_t key;
+  int half_move;
+  Move move;
+  // Piece type the move captured, -1 if none.
+  int8_t captured_piece;
+  // Castling rights before the move, one bit per CastlingRights value.
+  uint8_t castling;
+  Square ep_square;
+};
+
+class Game {
+public:
+  Game() : Game(default_fen) {}
+  Game(const Board &board) : board_(board) {}
+  Game(const std::string &fen) : board_(Board::from_fen(fen)) {}
+
+  void make_move(const Move move);
+  void make_null_move();
+  void unmake_move();
+
+  const Board &board() const { return board_; }
+
+  bool drawn() const;
+
+private:
+  bool is_stalemate() const;
+  bool is_fifty_move() const;
+  bool is_repetition() const;
+  // unmake_move() specialized on the side that made the move, so that
+  // directions and castling squares fold into constants.
+  template <Side side> void unmake_move(const StateInfo &state);
+
+  inline static const std::string default_fen =
+      "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+  // The current board state, reflecting the last move's effect.
+  Board board_;
+  // Undo records for every move made, most recent last.
+  std::vector<StateInfo> states_;
+};
+} // namespace chess
@@ -1,69 +1,76 @@
-#pragma once
-
-#include <cstdint>
-
-#include "board.h"
-#include "square.h"
-
-namespace chess {
-enum Promotion {
-  kPromoteQueen = 0,
-  kPromoteRook = 1,
-  kPromoteBishop = 2,
-  kPromoteKnight = 3,
-};
-
-#pragma pack(push, 1)
-class Move {
-public:
-  Move(Square from = 0, Square to = 0, bool capture = false, bool ep = false,
-       Promotion promotion = kPromoteQueen)
-      : from_(from.index()), to_(to.index()), capture_(capture), ep_(ep),
-        promotion_(promotion){};
-
-  Square from() const { return from_; };
-  Square to() const { return to_; };
-  bool capture() const { return capture_; };
-  bool en_passant() const { return ep_; }
-  uint32_t promotion() const { return promotion_; }
-  uint32_t promotion_piece_type() const {
-    constexpr int piece_types[] = {kPieceQueen, kPieceRook, kPieceBishop,
-                                   kPieceKnight};
-    return piece_types[promotion_];
-  }
-  bool castling(const Board &board) const {
-    auto kings = board.kings();
-    if (!kings.occupied(from_)) {
-      return false;
-    }
-
-    auto from_square = from();
-    auto to_square = to();
-
-    if (from_square.rank() != to_square.rank()) {
-      return false;
-    }
-
-    auto distance = abs(from_square.file() - to_square.file());
-    return distance > 1;
-  }
-  bool null() const { return !from_ && !to_; }
-
-  bool operator==(const chess::Move &move) const {
-    return from() == move.from() && to() == move.to() &&
-           capture_ == move.capture() && ep_ == move.en_passant() &&
-           promotion_ == move.promotion();
-  }
-  bool operator!=(const chess::Move &move) const { return !(*this == move); }
-
-private:
-  uint8_t from_ : 6;
-  uint8_t to_ : 6;
-  bool capture_ : 1;
-  // En passant
-  bool ep_ : 1;
-  uint32_t promotion_ : 2;
-};
-#pragma pack(pop)
-// static_assert(sizeof(Move) == 2, "Bad chess::Move size");
-} // namespace chess
\ No newline at end of file
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "board.h"
+#include "square.h"
+
+namespace chess {
+enum Promotion {
+  kPromoteQueen = 0,
+  kPromoteRook = 1,
+  kPromoteBishop = 2,
+  kPromoteKnight = 3,
+};
+
+// What a move does besides moving a piece, stored in its top four bits. Bit 2
+// marks captures and bit 3 promotions, whose low two bits hold the
+// Promotion.
+enum MoveFlag {
+  kMoveQuiet = 0,
+  kMoveDoublePush = 1,
+  kMoveKingCastle = 2,
+  kMoveQueenCastle = 3,
+  kMoveCapture = 4,
+  kMoveEnPassant = 5,
+  kMovePromotion = 8,
+  kMovePromotionCapture = 12,
+};
+
+// A move packed into 16 bits: from square, to square, then a MoveFlag.
+class Move {
+public:
+  constexpr Move() : data_(0) {}
+  constexpr Move(Square from, Square to, MoveFlag flag = kMoveQuiet)
+      : data_(from.index() | to.index() << 6 | flag << 12) {}
+  constexpr Move(Square from, Square to, Promotion promotion, bool capture)
+      : Move(from, to,
+             MoveFlag(kMovePromotion | capture << 2 | promotion)) {}
+
+  Square from() const { return data_ & 0x3f; };
+  Square to() const { return (data_ >> 6) & 0x3f; };
+  MoveFlag flag() const { return MoveFlag(data_ >> 12); }
+  bool capture() const { return (data_ >> 14) & 1; };
+  bool en_passant() const { return flag() == kMoveEnPassant; }
+  bool double_push() const { return flag() == kMoveDoublePush; }
+  bool castling() const { return (flag() & ~1) == kMoveKingCastle; }
+  bool promotes() const { return data_ >> 15; }
+  // Only meaningful if the move promotes.
+  Promotion promotion() const { return Promotion((data_ >> 12) & 3); }
+  int promotion_piece_type() const { return kPieceQueen - promotion(); }
+  bool null() const { return !data_; }
+  // The packed move, for storing it elsewhere.
+  uint16_t data() const { return data_; }
+
+  // Writes the move in UCI notation, such as "e2e4" or "e7e8q", and a
+  // terminating null to |out|, which must hold 6 characters. Returns the
+  // length written, not counting the null.
+  size_t write_uci(char *out) const;
+  // Parses a move in UCI notation made from |board|, filling in its flag.
+  // Returns a null move if |uci| is malformed. Doesn't check that the move is
+  // legal.
+  static Move from_uci(const Board &board, std::string_view uci);
+
+  bool operator==(const chess::Move &move) const {
+    return data_ == move.data_;
+  }
+  bool operator!=(const chess::Move &move) const { return !(*this == move); }
+
+private:
+  uint16_t data_;
+};
+
+static_assert(sizeof(Move) == 2, "Bad chess::Move size");
+} // namespace chess
@@ -1,46 +1,96 @@
-#pragma once
-
-#include <array>
-
-#include "board.h"
-#include "game.h"
-#include "move.h"
-
-namespace chess {
-class MoveList {
-public:
-  MoveList() : moves_{}, num_moves_(0){};
-  MoveList(const std::array<chess::Move, 256> &moves, const int num_moves)
-      : moves_(moves), num_moves_(num_moves){};
-  MoveList(const MoveList &list) : MoveList(list.moves(), list.size()){};
-  void add_move(const chess::Move move) {
-    // Unsafe as hell. Very likely to never go above the limit of 256 without a
-    // serious logic error or hand made position.
-    moves_[num_moves_] = move;
-    num_moves_++;
-  }
-  const std::array<chess::Move, 256> &moves() const { return moves_; }
-  chess::Move move(int index) const { return moves_[index]; }
-  int size() const { return num_moves_; }
-
-private:
-  // Very likely above or near the limit of possible moves on one board.
-  std::array<chess::Move, 256> moves_;
-  int num_moves_;
-};
-
-class MoveGenerator {
-public:
-  MoveList generate_pseudolegal_moves(const Board &board);
-  MoveList generate_legal_moves(chess::Game &game);
-
-private:
-  void generate_pawn_moves(const Board &board, MoveList *moves);
-  void generate_knight_moves(const Board &board, MoveList *moves);
-  void generate_bishop_moves(const Board &board, MoveList *moves);
-  void generate_rook_moves(const Board &board, MoveList *moves);
-  void generate_queen_moves(const Board &board, MoveList *moves);
-  void generate_king_moves(const Board &board, MoveList *moves);
-  void generate_castling_moves(Game &game, MoveList *moves);
-};
-} // namespace chess
\ No newline at end of file
+#pragma once
+
+#include "board.h"
+#include "game.h"
+#include "move.h"
+#include "move_list.h"
+
+namespace chess {
+// Kinds of move a MoveGenerator can produce. Each mode is its own
+// instantiation of the generator, so the work for move kinds a mode leaves out
+// compiles away.
+enum GenerationMode {
+  // Captures, including en passant, and every promotion.
+  kCaptures = 0,
+  // Moves that neither capture nor promote, including castling.
+  kQuiets = 1,
+  // Every legal move out of check. Only valid while the side to move is in
+  // check.
+  kEvasions = 2,
+  // Quiet moves that give check, directly or by discovery. Castling is not
+  // included.
+  kQuietChecks = 3,
+  // Every legal move.
+  kLegal = 4,
+  // Every move ignoring checks and pins, without castling.
+  kPseudolegal = 5,
+};
+
+class MoveGenerator {
+public:
+  template <GenerationMode mode> MoveList generate(const Board &board);
+  // Appends the moves to |moves| instead of returning a new list.
+  template <GenerationMode mode>
+  void generate(const Board &board, MoveList *moves);
+  MoveList generate_pseudolegal_moves(const Board &board);
+  MoveList generate_legal_moves(const chess::Game &game);
+  MoveList generate_legal_moves(const Board &board);
+  // Whether |move| is one of the legal moves on |board|. Only generates moves
+  // for the piece being moved.
+  bool legal(const Board &board, const Move move);
+  // Number of legal moves on |board|, counted without generating them. Moves
+  // of unpinned pieces are counted a whole target set at a time.
+  int count_legal_moves(const Board &board);
+
+private:
+  // Runtime restrictions applied on top of the generation mode. Legal modes
+  // limit moves to check evasions and keep pinned pieces on their pin rays.
+  struct MoveMask {
+    // Pieces that may move.
+    Bitboard sources;
+    // Squares any piece may move to. Everything but our own pieces, unless
+    // we're looking for a single move.
+    Bitboard destinations;
+    // Squares a piece other than the king may move to in order to capture or
+    // block a checker. Every square when not in check.
+    Bitboard evasions;
+    // Enemy pieces giving check.
+    Bitboard checkers;
+    // Pieces pinned to their own king.
+    Bitboard pinned;
+    Square king;
+    // Quiet check generation only. Squares from which each piece type would
+    // attack the enemy king, and our pieces that uncover a check by moving
+    // off the line to it.
+    Bitboard check_squares[kNumPieces];
+    Bitboard discoverers;
+    Square enemy_king;
+  };
+
+  // Every generator is specialized on the side to move, so that directions,
+  // ranks and castling squares fold into constants. generate() and legal()
+  // dispatch on Board::turn() once.
+  template <Side side, GenerationMode mode>
+  MoveMask move_mask(const Board &board);
+  template <Side side, GenerationMode mode>
+  void generate_moves(const Board &board, const MoveMask &mask,
+                      MoveList *moves);
+  template <Side side>
+  void generate_single_move(const Board &board, const Move move,
+                            MoveList *moves);
+  template <Side side, GenerationMode mode>
+  void generate_pawn_moves(const Board &board, const MoveMask &mask,
+                           MoveList *moves);
+  template <Side side, GenerationMode mode, int piece_type>
+  void generate_piece_moves(const Board &board, const MoveMask &mask,
+                            MoveList *moves);
+  template <Side side, GenerationMode mode>
+  void generate_king_moves(const Board &board, const MoveMask &mask,
+                           MoveList *moves);
+  template <Side side>
+  void generate_castling_moves(const Board &board, const MoveMask &mask,
+                               MoveList *moves);
+  template <Side side>
+  int count_moves(const Board &board, const MoveMask &mask);
+};
+} // namespace chess
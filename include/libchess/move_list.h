@@ -0,0 +1,86 @@
+#pragma once
+
+#include <assert.h>
+
+#include <utility>
+
+#include "move.h"
+
+namespace chess {
+// Most legal moves any chess position has.
+constexpr int max_moves = 218;
+// Room for pseudo-legal moves too, which can outnumber the legal ones.
+// Board::parse_fen() rejects material no game can reach, which keeps FEN
+// positions within this.
+constexpr int max_pseudolegal_moves = 256;
+
+// Fixed capacity list of moves with a score next to each, for ordering them
+// in place. Lives entirely on the stack and only copies the moves it holds.
+template <int capacity> class BasicMoveList {
+public:
+  BasicMoveList() : size_(0) {}
+  BasicMoveList(const BasicMoveList &list) : size_(list.size_) {
+    copy_from(list);
+  }
+  BasicMoveList &operator=(const BasicMoveList &list) {
+    size_ = list.size_;
+    copy_from(list);
+    return *this;
+  }
+
+  void add_move(const Move move) {
+    assert(size_ < capacity);
+    scores_[size_] = 0;
+    moves_[size_++] = move;
+  }
+  void clear() { size_ = 0; }
+
+  Move move(int index) const { return moves_[index]; }
+  int size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  bool contains(const Move move) const {
+    for (auto i = 0; i < size_; i++) {
+      if (moves_[i] == move) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // Scores start out 0 when add_move() adds a move.
+  int score(int index) const { return scores_[index]; }
+  void set_score(int index, int score) { scores_[index] = score; }
+  // Swaps the highest scoring move at or after |index| into |index|, one step
+  // of a selection sort, and returns it.
+  Move pick_best(int index) {
+    auto best = index;
+    for (auto i = index + 1; i < size_; i++) {
+      if (scores_[i] > scores_[best]) {
+        best = i;
+      }
+    }
+
+    std::swap(moves_[index], moves_[best]);
+    std::swap(scores_[index], scores_[best]);
+    return moves_[index];
+  }
+
+  const Move *begin() const { return moves_; }
+  const Move *end() const { return moves_ + size_; }
+
+private:
+  void copy_from(const BasicMoveList &list) {
+    for (auto i = 0; i < size_; i++) {
+      moves_[i] = list.moves_[i];
+      scores_[i] = list.scores_[i];
+    }
+  }
+
+  Move moves_[capacity];
+  int scores_[capacity];
+  int size_;
+};
+
+using MoveList = BasicMoveList<max_pseudolegal_moves>;
+} // namespace chess
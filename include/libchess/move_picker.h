@@ -0,0 +1,58 @@
+#pragma once
+
+#include "board.h"
+#include "move.h"
+#include "move_generator.h"
+#include "move_list.h"
+
+namespace chess {
+// Hands out the legal moves of a position one at a time, generating each stage
+// only once the previous one has run out. A search that cuts off early never
+// pays for the stages it didn't reach. Captures and promotions are generated
+// together, quiet moves separately.
+//
+// Moves are returned in this order:
+//  1. The supplied best move (e.g. from a transposition table), if it's legal.
+//  2. Captures, most valuable victim first, then least valuable attacker.
+//  3. Promotions, queens first.
+//  4. The supplied killer moves, if they're legal quiet moves.
+//  5. The remaining quiet moves, including castling.
+class MovePicker {
+public:
+  MovePicker(const Board &board, const Move best_move = Move(),
+             const Move first_killer = Move(),
+             const Move second_killer = Move());
+
+  // Returns the next move to try, or a null move once every legal move has
+  // been returned.
+  Move next();
+
+private:
+  enum Phase {
+    kPhaseBestMove,
+    kPhaseGenerateCaptures,
+    kPhaseCaptures,
+    kPhaseGenerateQuiets,
+    kPhaseKillers,
+    kPhaseQuiets,
+    kPhaseDone,
+  };
+
+  // Replaces the current stage's moves with those of |mode|.
+  template <GenerationMode mode> void load();
+  void score_captures();
+  // Whether |move| was already returned by an earlier phase.
+  bool returned_early(const Move move) const;
+
+  const Board &board_;
+  MoveGenerator generator_;
+  Move best_move_;
+  Move killers_[2];
+  int killer_index_;
+  Phase phase_;
+
+  // Moves of the current stage. Everything before |index_| has been returned.
+  MoveList moves_;
+  int index_;
+};
+} // namespace chess
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "board.h"
+#include "move.h"
+
+namespace chess {
+// Subtree counts of positions already counted, keyed by Zobrist key and depth.
+// Threads share one cache without locks. Each entry stores its key XORed with
+// its data, so an entry torn by two threads writing at once fails the check
+// on probe rather than returning a wrong count.
+class PerftCache {
+public:
+  // Uses at most |megabytes| of memory, rounded down to a power of two
+  // entries.
+  explicit PerftCache(size_t megabytes);
+
+  // Whether the subtree |depth| plies below the position with |key| was
+  // counted, storing the count in |nodes| if it was.
+  bool probe(uint64_t key, int depth, uint64_t *nodes) const;
+  void store(uint64_t key, int depth, uint64_t nodes);
+
+private:
+  struct Entry {
+    std::atomic<uint64_t> check;
+    // Node count in the top 56 bits, depth in the bottom 8.
+    std::atomic<uint64_t> data;
+  };
+  static_assert(sizeof(Entry) == 16, "PerftCache entries should be 16 bytes");
+
+  std::unique_ptr<Entry[]> entries_;
+  uint64_t mask_;
+};
+
+// Number of positions exactly |depth| plies below |board|, counting every
+// legal move sequence. The standard way to check a move generator against
+// known results. Subtrees already in |cache|, if given, aren't counted again.
+uint64_t perft(const Board &board, int depth, PerftCache *cache = nullptr);
+
+// Subtrees this shallow are always counted by the thread holding them by
+// default. Handing them out would cost more than counting them.
+constexpr int default_split_depth = 3;
+
+// perft() spread over |num_threads| threads, or one per core if 0. The tree
+// is split at the root, and deeper wherever a thread runs out of work while
+// others still have some left, down to subtrees |split_depth| plies deep.
+// Each thread keeps its own boards and counts, so the result is exactly the
+// same as perft()'s. All threads share |cache|, which only ever holds counts
+// of subtrees that were never split.
+uint64_t parallel_perft(const Board &board, int depth, int num_threads = 0,
+                        PerftCache *cache = nullptr,
+                        int split_depth = default_split_depth);
+
+// Count below one legal move at the root.
+struct PerftDivision {
+  Move move;
+  uint64_t nodes;
+};
+
+// Splits the perft() count of |board| by root move, in generation order, to
+// narrow down which line a wrong count comes from. |depth| must be at least
+// 1. Each subtree is counted by parallel_perft().
+std::vector<PerftDivision> perft_divide(const Board &board, int depth,
+                                        int num_threads = 0,
+                                        PerftCache *cache = nullptr);
+} // namespace chess
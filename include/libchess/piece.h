@@ -1,21 +1,139 @@
-#pragma once
-
-#include "bitboard.h"
-#include "square.h"
-
-namespace chess {
-Bitboard pawn_move_board(int side, Square square);
-Bitboard pawn_double_move_board(int side, Square square);
-Bitboard pawn_attack_board(int side, Square square);
-Bitboard pawn_attack_board(int side, Bitboard squares);
-Bitboard knight_attack_board(Square square);
-Bitboard knight_attack_board(Bitboard squares);
-Bitboard bishop_attack_board(Bitboard occupied, Square square);
-Bitboard bishop_attack_board(Bitboard occupied, Bitboard squares);
-Bitboard rook_attack_board(Bitboard occupied, Square square);
-Bitboard rook_attack_board(Bitboard occupied, Bitboard squares);
-Bitboard queen_attack_board(Bitboard occupied, Square square);
-Bitboard queen_attack_board(Bitboard occupied, Bitboard squares);
-Bitboard king_attack_board(Square square);
-Bitboard king_attack_board(Bitboard squares);
-} // namespace chess
\ No newline at end of file
+#pragma once
+
+#include <stddef.h>
+
+#include <array>
+
+#include "bitboard.h"
+#include "platform.h"
+#include "square.h"
+
+namespace chess {
+// Fancy magic bitboard entry for a single square. The blockers on the square's
+// relevant rays are hashed into an index within the slider's attack table,
+// either by a magic multiply or by PEXT on BMI2 builds.
+struct Magic {
+  uint64_t mask = 0;
+  uint64_t magic = 0;
+  uint32_t offset = 0;
+  uint32_t shift = 0;
+
+  uint32_t index(uint64_t occupied) const {
+#if CHESSLIB_PEXT
+    return offset +
+           static_cast<uint32_t>(platform::parallel_bits_extract(occupied, mask));
+#else
+    return offset +
+           static_cast<uint32_t>(((occupied & mask) * magic) >> shift);
+#endif
+  }
+};
+
+template <size_t table_size> struct SliderTable {
+  std::array<Magic, 64> magics;
+  std::array<Bitboard, table_size> attacks;
+
+  Bitboard attack_board(uint64_t occupied, Square square) const {
+    return attacks[magics[square.index()].index(occupied)];
+  }
+};
+
+// Number of attack sets across all squares, i.e. the sum of 2^(relevant bits)
+// for every square.
+constexpr size_t bishop_table_size = 0x1480;
+constexpr size_t rook_table_size = 0x19000;
+
+// Attack look up tables, defined in piece.cc. Everything but the slider tables
+// is computed at compile time. Pawn tables are indexed by side first. The
+// slider tables are too large for that, and are filled in by SliderTableInit.
+extern const std::array<std::array<Bitboard, 64>, 2> pawn_move_tables;
+extern const std::array<std::array<Bitboard, 64>, 2> pawn_double_move_tables;
+extern const std::array<std::array<Bitboard, 64>, 2> pawn_capture_tables;
+extern const std::array<Bitboard, 64> knight_attack_table;
+extern const std::array<Bitboard, 64> king_attack_table;
+extern const std::array<std::array<Bitboard, 64>, 64> between_table;
+extern const std::array<std::array<Bitboard, 64>, 64> line_table;
+extern SliderTable<bishop_table_size> bishop_table;
+extern SliderTable<rook_table_size> rook_table;
+
+// Fills in the slider tables the first time one is constructed. Every
+// translation unit including this header gets its own instance below, ahead
+// of its own static objects, so even their initializers can look up slider
+// attacks. Works the same way as <iostream> setting up std::cout.
+struct SliderTableInit {
+  SliderTableInit();
+};
+static const SliderTableInit slider_table_init;
+
+inline Bitboard pawn_move_board(int side, Square square) {
+  return pawn_move_tables[side][square.index()];
+}
+
+inline Bitboard pawn_double_move_board(int side, Square square) {
+  return pawn_double_move_tables[side][square.index()];
+}
+
+inline Bitboard pawn_attack_board(int side, Square square) {
+  return pawn_capture_tables[side][square.index()];
+}
+
+inline Bitboard knight_attack_board(Square square) {
+  return knight_attack_table[square.index()];
+}
+
+inline Bitboard king_attack_board(Square square) {
+  return king_attack_table[square.index()];
+}
+
+// Reference slider attacks computed by scanning each ray for its first blocker.
+// Slower than the magic bitboard tables used by the functions below, but
+// simple enough to validate them against.
+Bitboard bishop_ray_attack_board(Bitboard occupied, Square square);
+Bitboard rook_ray_attack_board(Bitboard occupied, Square square);
+Bitboard queen_ray_attack_board(Bitboard occupied, Square square);
+
+inline Bitboard bishop_attack_board(Bitboard occupied, Square square) {
+#if CHESSLIB_RAY_ATTACKS
+  return bishop_ray_attack_board(occupied, square);
+#else
+  return bishop_table.attack_board(occupied.data(), square);
+#endif
+}
+
+inline Bitboard rook_attack_board(Bitboard occupied, Square square) {
+#if CHESSLIB_RAY_ATTACKS
+  return rook_ray_attack_board(occupied, square);
+#else
+  return rook_table.attack_board(occupied.data(), square);
+#endif
+}
+
+inline Bitboard queen_attack_board(Bitboard occupied, Square square) {
+#if CHESSLIB_RAY_ATTACKS
+  return queen_ray_attack_board(occupied, square);
+#else
+  return bishop_table.attack_board(occupied.data(), square) |
+         rook_table.attack_board(occupied.data(), square);
+#endif
+}
+
+// Squares strictly between two squares on a shared rank, file or diagonal.
+// Empty if the squares aren't aligned.
+inline Bitboard between_board(Square from, Square to) {
+  return between_table[from.index()][to.index()];
+}
+
+// The full rank, file or diagonal passing through both squares. Empty if the
+// squares aren't aligned.
+inline Bitboard line_board(Square from, Square to) {
+  return line_table[from.index()][to.index()];
+}
+
+// Union of the attacks from every square on |squares|.
+Bitboard pawn_attack_board(int side, Bitboard squares);
+Bitboard knight_attack_board(Bitboard squares);
+Bitboard bishop_attack_board(Bitboard occupied, Bitboard squares);
+Bitboard rook_attack_board(Bitboard occupied, Bitboard squares);
+Bitboard queen_attack_board(Bitboard occupied, Bitboard squares);
+Bitboard king_attack_board(Bitboard squares);
+} // namespace chess
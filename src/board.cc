@@ -1,369 +1,603 @@
-#include <cstring>
-#include <iostream>
-#include <regex>
-#include <sstream>
-
-#include <libchess/bitboard_iterator.h>
-#include <libchess/board.h>
-#include <libchess/piece.h>
-
-namespace chess {
-Board null_board({0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {0, 0}, {1, 1, 1, 1},
-                 0, -1, 0, 0);
-
-inline int char_to_int(char ch) { return ch - 48; }
-
-inline int square_name_to_offset(std::string square_name) {
-  auto file_offset = static_cast<int>(square_name.at(0) - 'a');
-  auto rank_offset = static_cast<int>(square_name.at(1) - '1') * 8;
-  auto square = file_offset + rank_offset;
-  return square;
-}
-
-inline std::string square_index_to_name(Square square) {
-  std::stringstream stream;
-  stream << static_cast<char>(square.file() + 'a');
-  stream << static_cast<char>(square.rank() + '1');
-  return stream.str();
-}
-
-Board::Board(std::vector<Bitboard> pawns, std::vector<Bitboard> knights,
-             std::vector<Bitboard> bishops, std::vector<Bitboard> rooks,
-             std::vector<Bitboard> queens, std::vector<Bitboard> kings,
-             std::vector<bool> castling, int side, Square ep_square,
-             int half_move, int full_move)
-    : side_(side), half_move_(half_move), full_move_(full_move),
-      ep_square_(ep_square) {
-  for (auto i = 0; i < kNumSides; i++) {
-    this->pieces_[i][kPiecePawn] = pawns[i];
-    this->pieces_[i][kPieceKnight] = knights[i];
-    this->pieces_[i][kPieceBishop] = bishops[i];
-    this->pieces_[i][kPieceRook] = rooks[i];
-    this->pieces_[i][kPieceQueen] = queens[i];
-    this->pieces_[i][kPieceKing] = kings[i];
-  }
-
-  for (auto i = 0; i < kNumCastle; i++) {
-    this->castling_[i] = castling[i];
-  }
-
-  this->update_occupied();
-}
-
-bool Board::operator==(const Board &board) const {
-  for (auto side = 0; side < 2; side++) {
-    if (this->pawns(side) != board.pawns(side)) {
-      return false;
-    }
-    if (this->knights(side) != board.knights(side)) {
-      return false;
-    }
-    if (this->bishops(side) != board.bishops(side)) {
-      return false;
-    }
-    if (this->rooks(side) != board.rooks(side)) {
-      return false;
-    }
-    if (this->queens(side) != board.queens(side)) {
-      return false;
-    }
-    if (this->kings(side) != board.kings(side)) {
-      return false;
-    }
-
-    for (auto castle_side = 0; castle_side < kNumCastle; castle_side++) {
-      if (this->castling(castle_side) != board.castling(castle_side)) {
-        return false;
-      }
-    }
-  }
-
-  if (this->turn() != board.turn()) {
-    return false;
-  }
-
-  if (this->ep_square() != board.ep_square()) {
-    return false;
-  }
-
-  if (this->half_move() != board.half_move()) {
-    return false;
-  }
-
-  if (this->full_move() != board.full_move()) {
-    return false;
-  }
-
-  return true;
-}
-
-Board Board::from_fen(std::string fen) {
-  // FEN strings look like this:
-  // rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1
-  // rnbq1bnr/pp2k1pp/5p2/1Bp1N3/3p2P1/4P2P/PPPP1P2/RNBQK2R w KQ - 2 7
-  // 1r4nn/p4k1r/3P3b/4RppP/1P6/P1NR1B1P/2PB1P2/6K1 b - - 4 34
-  std::vector<Bitboard> pawns = {0, 0};
-  std::vector<Bitboard> knights = {0, 0};
-  std::vector<Bitboard> bishops = {0, 0};
-  std::vector<Bitboard> rooks = {0, 0};
-  std::vector<Bitboard> queens = {0, 0};
-  std::vector<Bitboard> kings = {0, 0};
-  std::vector<bool> castling = {false, false, false, false};
-  int side = 0;
-  int ep_square = -1;
-  int halfmove = 0;
-  int fullmove = 0;
-
-  std::regex fen_exp("(.+) (.) (.+) (.+) (.+) (.+)");
-  std::smatch fen_match;
-  if (!std::regex_search(fen, fen_match, fen_exp)) {
-    return null_board;
-  }
-
-  if (fen_match.length() < 7) {
-    return null_board;
-  }
-
-  auto fen_pieces = fen_match[1].str();
-  {
-    std::vector<std::string> ranks = {};
-    // TODO: use a c++ string equivalent here. strtok is used because the
-    // current solution that exists in c++ is awful.
-    {
-      char token_str[1024] = {'\0'};
-      fen_pieces.copy(token_str, 1024, 0);
-      char *token = std::strtok(token_str, "/");
-      while (ranks.size() < 8) {
-        ranks.push_back(token);
-        token = std::strtok(NULL, "/");
-      }
-    }
-
-    for (auto i = 0; i < 8; i++) {
-      // Ranks in FEN format are from highest to lowest
-      auto rank = 7 - i;
-      auto rank_str = ranks[i];
-      // Offset of the current rank into a bitboard
-      auto rank_offset = 8 * rank;
-      // Number of tiles filled in the current rank
-      int rank_filled = 0;
-      for (char &ch : rank_str) {
-        if (std::isdigit(ch)) {
-          auto num = char_to_int(ch);
-          rank_filled += num;
-        } else {
-          int piece_side = std::isupper(ch) ? 0 : 1;
-          auto piece_type = std::tolower(ch);
-          Bitboard board = 0;
-          switch (piece_type) {
-          case 'p':
-            board = pawns[piece_side];
-            break;
-          case 'n':
-            board = knights[piece_side];
-            break;
-          case 'b':
-            board = bishops[piece_side];
-            break;
-          case 'r':
-            board = rooks[piece_side];
-            break;
-          case 'q':
-            board = queens[piece_side];
-            break;
-          case 'k':
-            board = kings[piece_side];
-            break;
-          default:
-            break;
-          }
-
-          board.set(Square(rank_offset + rank_filled));
-          rank_filled++;
-
-          switch (piece_type) {
-          case 'p':
-            pawns[piece_side] = board;
-            break;
-          case 'n':
-            knights[piece_side] = board;
-            break;
-          case 'b':
-            bishops[piece_side] = board;
-            break;
-          case 'r':
-            rooks[piece_side] = board;
-            break;
-          case 'q':
-            queens[piece_side] = board;
-            break;
-          case 'k':
-            kings[piece_side] = board;
-            break;
-          default:
-            break;
-          }
-        }
-      }
-    }
-  }
-
-  auto fen_side = fen_match[2].str();
-  { side = fen_side.compare("w") == 0 ? kSideWhite : kSideBlack; }
-
-  auto fen_castling = fen_match[3].str();
-  {
-    if (fen_castling.compare("-") != 0) {
-      if (fen_castling.find("K") != std::string::npos) {
-        castling[kCastleWhiteKingSide] = true;
-      }
-
-      if (fen_castling.find("Q") != std::string::npos) {
-        castling[kCastleWhiteQueenSide] = true;
-      }
-
-      if (fen_castling.find("k") != std::string::npos) {
-        castling[kCastleBlackKingSide] = true;
-      }
-
-      if (fen_castling.find("q") != std::string::npos) {
-        castling[kCastleBlackQueenSide] = true;
-      }
-    }
-  }
-
-  auto fen_ep = fen_match[4].str();
-  {
-    if (fen_ep.compare("-") != 0) {
-      ep_square = square_name_to_offset(fen_ep);
-    }
-  }
-
-  auto fen_halfmove = fen_match[5].str();
-  halfmove = std::stoi(fen_halfmove);
-
-  auto fen_fullmove = fen_match[6].str();
-  fullmove = std::stoi(fen_fullmove);
-
-  return Board(pawns, knights, bishops, rooks, queens, kings, castling, side,
-               ep_square, halfmove, fullmove);
-}
-
-std::string Board::fen() const {
-  const char piece_symbols[] = {
-      'p', 'n', 'b', 'r', 'q', 'k',
-  };
-
-  const char turn_symbols[] = {'w', 'b'};
-
-  std::stringstream stream;
-
-  for (auto rank = 7; rank >= 0; --rank) {
-    if (rank < 7) {
-      stream << "/";
-    }
-
-    int empty = 0;
-    for (auto file = 0; file < 8; file++) {
-      auto square = Square(file, rank);
-      const auto white_piece = piece_type_at(kSideWhite, square);
-      const auto black_piece = piece_type_at(kSideBlack, square);
-      if (white_piece == -1 && black_piece == -1) {
-        empty++;
-        continue;
-      }
-
-      if (empty) {
-        stream << empty;
-        empty = 0;
-      }
-
-      auto symbol = '\0';
-      if (white_piece >= kPiecePawn) {
-        symbol = std::toupper(piece_symbols[white_piece]);
-      } else {
-        symbol = piece_symbols[black_piece];
-      }
-
-      stream << symbol;
-    }
-
-    if (empty) {
-      stream << empty;
-      empty = 0;
-    }
-  }
-
-  stream << " " << turn_symbols[turn()];
-
-  {
-    // TODO: clean this up
-    const char castle_symbols[] = {'K', 'Q', 'k', 'q'};
-
-    stream << " ";
-
-    bool can_castle = false;
-    for (int castle_side = 0; castle_side < kNumCastle; castle_side++) {
-      if (castling(castle_side)) {
-        can_castle = true;
-        stream << castle_symbols[castle_side];
-      }
-    }
-
-    if (!can_castle) {
-      stream << "-";
-    }
-  }
-
-  {
-    // TODO: clean this up
-    auto square = ep_square();
-    if (square == null_square) {
-      stream << " -";
-    } else {
-      stream << " " << square_index_to_name(square);
-    }
-  }
-
-  stream << " " << half_move();
-  stream << " " << full_move();
-
-  return stream.str();
-}
-
-uint64_t Board::attacks_to_square(int side, Square square) const {
-  const auto pawn_board = piece_board(side, kPiecePawn);
-  const auto pawn_attacks = pawn_attack_board(side, pawn_board);
-
-  const auto knight_board = piece_board(side, kPieceKnight);
-  const auto knight_attacks = knight_attack_board(knight_board);
-
-  const auto bishop_board = piece_board(side, kPieceBishop);
-  const auto bishop_attacks = bishop_attack_board(occupied(), bishop_board);
-
-  const auto rook_board = piece_board(side, kPieceRook);
-  const auto rook_attacks = rook_attack_board(occupied(), rook_board);
-
-  const auto queen_board = piece_board(side, kPieceQueen);
-  const auto queen_attacks = queen_attack_board(occupied(), queen_board);
-
-  const auto king_board = piece_board(side, kPieceKing);
-  const auto king_attacks = king_attack_board(king_board);
-
-  return pawn_attacks.occupied(square) | knight_attacks.occupied(square) |
-         bishop_attacks.occupied(square) | rook_attacks.occupied(square) |
-         queen_attacks.occupied(square) | king_attacks.occupied(square);
-}
-
-bool Board::check(int side) const {
-  auto kings = this->kings(side);
-  BitboardIterator king_iter(kings);
-  while (king_iter.has_data()) {
-    auto square = king_iter.next();
-    return attacks_to_square(!side, square);
-  }
-
-  return false;
-}
-
-} // namespace chess
\ No newline at end of file
+#include <assert.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+
+#include <libchess/bitboard_iterator.h>
+#include <libchess/board.h>
+#include <libchess/move.h>
+#include <libchess/piece.h>
+
+namespace chess {
+constexpr ZobristKeys compute_zobrist_keys() {
+  ZobristKeys keys{};
+
+  // xorshift64* with a fixed seed, so keys are the same on every build.
+  uint64_t state = 0x9e3779b97f4a7c15ull;
+  auto next = [&state]() {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ull;
+  };
+
+  for (auto side = 0; side < kNumSides; side++) {
+    for (auto piece_type = 0; piece_type < kNumPieces; piece_type++) {
+      for (auto square = 0; square < 64; square++) {
+        keys.pieces[side][piece_type][square] = next();
+      }
+    }
+  }
+  keys.side = next();
+  for (auto castle_side = 0; castle_side < kNumCastle; castle_side++) {
+    keys.castling[castle_side] = next();
+  }
+  for (auto file = 0; file < 8; file++) {
+    keys.ep_file[file] = next();
+  }
+
+  return keys;
+}
+
+constexpr ZobristKeys zobrist_keys = compute_zobrist_keys();
+
+Board null_board({}, 0xf, kSideWhite, null_square, 0, 0);
+
+// Writes |value| in decimal and returns the number of characters written.
+inline size_t write_number(unsigned value, char *out) {
+  char digits[10];
+  size_t count = 0;
+  do {
+    digits[count++] = '0' + value % 10;
+    value /= 10;
+  } while (value);
+
+  for (size_t i = 0; i < count; i++) {
+    out[i] = digits[count - 1 - i];
+  }
+  return count;
+}
+
+// Castling rights lost when a piece moves from or to each square. Only the
+// kings' and rooks' starting squares lose any.
+constexpr std::array<uint8_t, 64> compute_castling_masks() {
+  std::array<uint8_t, 64> masks = {};
+  masks[Square(4, 0).index()] =
+      1 << kCastleWhiteKingSide | 1 << kCastleWhiteQueenSide;
+  masks[Square(7, 0).index()] = 1 << kCastleWhiteKingSide;
+  masks[Square(0, 0).index()] = 1 << kCastleWhiteQueenSide;
+  masks[Square(4, 7).index()] =
+      1 << kCastleBlackKingSide | 1 << kCastleBlackQueenSide;
+  masks[Square(7, 7).index()] = 1 << kCastleBlackKingSide;
+  masks[Square(0, 7).index()] = 1 << kCastleBlackQueenSide;
+  return masks;
+}
+
+constexpr std::array<uint8_t, 64> castling_masks = compute_castling_masks();
+
+Board::Board()
+    : pieces_{}, sides_{}, key_(0), half_move_(0), full_move_(1),
+      castling_(0), side_(kSideWhite), ep_square_(null_square) {
+  std::memset(piece_on_, -1, sizeof(piece_on_));
+}
+
+Board::Board(const Bitboard (&pieces)[kNumSides][kNumPieces],
+             uint8_t castling, int side, Square ep_square, int half_move,
+             int full_move)
+    : pieces_{}, sides_{}, half_move_(half_move), full_move_(full_move),
+      castling_(castling), side_(side), ep_square_(ep_square) {
+  std::memset(piece_on_, -1, sizeof(piece_on_));
+  for (auto piece_side = 0; piece_side < kNumSides; piece_side++) {
+    for (auto piece_type = 0; piece_type < kNumPieces; piece_type++) {
+      const auto &board = pieces[piece_side][piece_type];
+      pieces_[piece_type] |= board;
+      sides_[piece_side] |= board;
+
+      BitboardIterator square_iter(board);
+      while (square_iter.has_data()) {
+        piece_on_[square_iter.next().index()] = piece_type;
+      }
+    }
+  }
+
+  key_ = compute_key();
+}
+
+void Board::set_piece_board(int side, int piece_type, Bitboard board) {
+  const auto current = piece_board(side, piece_type);
+
+  BitboardIterator removed_iter(current & ~board);
+  while (removed_iter.has_data()) {
+    remove_piece(side, piece_type, removed_iter.next());
+  }
+
+  BitboardIterator added_iter(board & ~current);
+  while (added_iter.has_data()) {
+    put_piece(side, piece_type, added_iter.next());
+  }
+}
+
+int Board::make_move(const Move move) {
+  if (side_ == kSideWhite) {
+    return make_move<kSideWhite>(move);
+  } else {
+    return make_move<kSideBlack>(move);
+  }
+}
+
+template <Side side> int Board::make_move(const Move move) {
+  assert(!move.null());
+  assert(side_ == side);
+
+  constexpr Side enemy = side == kSideWhite ? kSideBlack : kSideWhite;
+  constexpr int up = side == kSideWhite ? 8 : -8;
+
+  const auto from = move.from();
+  const auto to = move.to();
+  const auto from_piece_type = piece_type_at(from);
+
+  int captured_piece = -1;
+  if (move.capture()) {
+    if (move.en_passant()) {
+      captured_piece = kPiecePawn;
+      remove_piece(enemy, kPiecePawn, Square(to.index() - up));
+    } else {
+      captured_piece = piece_type_at(to);
+      remove_piece(enemy, captured_piece, to);
+    }
+  }
+
+  if (move.promotes()) {
+    remove_piece(side, kPiecePawn, from);
+    put_piece(side, move.promotion_piece_type(), to);
+  } else {
+    move_piece(side, from_piece_type, from, to);
+    if (move.castling()) {
+      const auto castle = 2 * side + move.flag() - kMoveKingCastle;
+      move_piece(side, kPieceRook, castling_rook_from[castle],
+                 castling_rook_to[castle]);
+    }
+  }
+
+  const auto lost_castling =
+      castling_masks[from.index()] | castling_masks[to.index()];
+  if (castling_ & lost_castling) {
+    set_castling_rights(castling_ & ~lost_castling);
+  }
+
+  // Only kept, and hashed, when an enemy pawn can take it. Otherwise the same
+  // position reached without the double push would get another key and
+  // repetitions would be missed.
+  auto ep_square = null_square;
+  if (move.double_push() &&
+      (pawn_attack_board(side, Square(from.index() + up)) &
+       piece_board(enemy, kPiecePawn))
+          .data()) {
+    ep_square = Square(from.index() + up);
+  }
+  set_ep_square(ep_square);
+
+  if (move.capture() || from_piece_type == kPiecePawn) {
+    half_move_ = 0;
+  } else {
+    half_move_++;
+  }
+  full_move_ += side;
+  set_turn(enemy);
+
+  assert(key_ == compute_key());
+  return captured_piece;
+}
+
+Board Board::after(const Move move) const {
+  auto board = *this;
+  board.make_move(move);
+  return board;
+}
+
+bool Board::operator==(const Board &board) const {
+  if (key_ != board.key_) {
+    return false;
+  }
+
+  for (auto piece_type = 0; piece_type < kNumPieces; piece_type++) {
+    if (this->piece_board(piece_type) != board.piece_board(piece_type)) {
+      return false;
+    }
+  }
+
+  for (auto side = 0; side < kNumSides; side++) {
+    if (this->occupied(side) != board.occupied(side)) {
+      return false;
+    }
+  }
+
+  if (this->castling_rights() != board.castling_rights()) {
+    return false;
+  }
+
+  if (this->turn() != board.turn()) {
+    return false;
+  }
+
+  if (this->ep_square() != board.ep_square()) {
+    return false;
+  }
+
+  if (this->half_move() != board.half_move()) {
+    return false;
+  }
+
+  if (this->full_move() != board.full_move()) {
+    return false;
+  }
+
+  return true;
+}
+
+// Spaces and tabs, and carriage returns left over from CRLF files.
+inline bool is_whitespace(char ch) {
+  return ch == ' ' || ch == '\t' || ch == '\r';
+}
+
+inline void skip_whitespace(std::string_view &text) {
+  while (!text.empty() && is_whitespace(text.front())) {
+    text.remove_prefix(1);
+  }
+}
+
+// Splits the next whitespace separated field off the front of |text|.
+inline std::string_view next_field(std::string_view &text) {
+  skip_whitespace(text);
+  size_t length = 0;
+  while (length < text.size() && !is_whitespace(text[length])) {
+    length++;
+  }
+
+  const auto field = text.substr(0, length);
+  text.remove_prefix(length);
+  return field;
+}
+
+// Parses a clock field. Fails on anything but digits, or values too large to
+// store.
+inline bool parse_clock(std::string_view field, int *value) {
+  if (field.empty() || field.size() > 5) {
+    return false;
+  }
+
+  int result = 0;
+  for (const auto ch : field) {
+    if (ch < '0' || ch > '9') {
+      return false;
+    }
+    result = result * 10 + (ch - '0');
+  }
+
+  if (result > 0xffff) {
+    return false;
+  }
+
+  *value = result;
+  return true;
+}
+
+inline int piece_type_from_symbol(char symbol) {
+  switch (symbol | 0x20) {
+  case 'p':
+    return kPiecePawn;
+  case 'n':
+    return kPieceKnight;
+  case 'b':
+    return kPieceBishop;
+  case 'r':
+    return kPieceRook;
+  case 'q':
+    return kPieceQueen;
+  case 'k':
+    return kPieceKing;
+  default:
+    return -1;
+  }
+}
+
+FenError Board::parse_fen(std::string_view fen, Board *board,
+                          std::string_view *rest) {
+  // FEN strings look like this:
+  // rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1
+  // rnbq1bnr/pp2k1pp/5p2/1Bp1N3/3p2P1/4P2P/PPPP1P2/RNBQK2R w KQ - 2 7
+  // 1r4nn/p4k1r/3P3b/4RppP/1P6/P1NR1B1P/2PB1P2/6K1 b - - 4 34
+  // EPD lines end after the en passant square, optionally followed by
+  // operations such as "bm Nf3;".
+  Bitboard pieces[kNumSides][kNumPieces] = {};
+  uint8_t castling = 0;
+  int side = kSideWhite;
+  Square ep_square = null_square;
+  int half_move = 0;
+  int full_move = 1;
+
+  const auto placement = next_field(fen);
+  if (placement.empty()) {
+    return kFenEmpty;
+  }
+
+  {
+    // Ranks in FEN format are from highest to lowest
+    int rank = 7;
+    int file = 0;
+    for (const auto ch : placement) {
+      if (ch == '/') {
+        if (file != 8 || rank == 0) {
+          return kFenBadPlacement;
+        }
+        rank--;
+        file = 0;
+      } else if (ch >= '1' && ch <= '8') {
+        file += ch - '0';
+        if (file > 8) {
+          return kFenBadPlacement;
+        }
+      } else {
+        const auto piece_type = piece_type_from_symbol(ch);
+        if (piece_type == -1 || file >= 8) {
+          return kFenBadPlacement;
+        }
+        const auto piece_side = ch < 'a' ? kSideWhite : kSideBlack;
+        pieces[piece_side][piece_type].set(Square(file, rank));
+        file++;
+      }
+    }
+
+    if (rank != 0 || file != 8) {
+      return kFenBadPlacement;
+    }
+
+    // Pieces beyond each side's starting set must have been promoted from
+    // its pawns. Positions breaking this can't occur in a game and could
+    // have more moves than a MoveList holds.
+    for (const auto &side_pieces : pieces) {
+      const auto pawns = side_pieces[kPiecePawn].count();
+      const auto promoted =
+          std::max(side_pieces[kPieceKnight].count() - 2, 0) +
+          std::max(side_pieces[kPieceBishop].count() - 2, 0) +
+          std::max(side_pieces[kPieceRook].count() - 2, 0) +
+          std::max(side_pieces[kPieceQueen].count() - 1, 0);
+      if (pawns + promoted > 8 || side_pieces[kPieceKing].count() > 1) {
+        return kFenBadPlacement;
+      }
+    }
+  }
+
+  const auto fen_side = next_field(fen);
+  if (fen_side == "w") {
+    side = kSideWhite;
+  } else if (fen_side == "b") {
+    side = kSideBlack;
+  } else {
+    return kFenBadSide;
+  }
+
+  const auto fen_castling = next_field(fen);
+  if (fen_castling.empty()) {
+    return kFenBadCastling;
+  }
+  if (fen_castling != "-") {
+    for (const auto ch : fen_castling) {
+      switch (ch) {
+      case 'K':
+        castling |= 1 << kCastleWhiteKingSide;
+        break;
+      case 'Q':
+        castling |= 1 << kCastleWhiteQueenSide;
+        break;
+      case 'k':
+        castling |= 1 << kCastleBlackKingSide;
+        break;
+      case 'q':
+        castling |= 1 << kCastleBlackQueenSide;
+        break;
+      default:
+        return kFenBadCastling;
+      }
+    }
+  }
+
+  const auto fen_ep = next_field(fen);
+  if (fen_ep.empty()) {
+    return kFenBadEnPassant;
+  }
+  if (fen_ep != "-") {
+    // Only a pawn that just moved two squares can be taken en passant, so the
+    // square is behind an enemy pawn on the fourth or fifth rank, and both
+    // it and the square the pawn came from are empty.
+    if (fen_ep.size() != 2 || fen_ep[0] < 'a' || fen_ep[0] > 'h' ||
+        fen_ep[1] != (side == kSideWhite ? '6' : '3')) {
+      return kFenBadEnPassant;
+    }
+    ep_square = Square(fen_ep[0] - 'a', fen_ep[1] - '1');
+
+    const auto enemy = side == kSideWhite ? kSideBlack : kSideWhite;
+    const auto up = side == kSideWhite ? 8 : -8;
+    Bitboard occupied;
+    for (const auto &side_pieces : pieces) {
+      for (const auto &piece_board : side_pieces) {
+        occupied |= piece_board;
+      }
+    }
+    if (occupied.occupied(ep_square) ||
+        occupied.occupied(Square(ep_square.index() + up)) ||
+        !pieces[enemy][kPiecePawn].occupied(Square(ep_square.index() - up))) {
+      return kFenBadEnPassant;
+    }
+  }
+
+  // Both clocks or neither, so that EPD operations aren't mistaken for them.
+  auto clocks = fen;
+  const auto fen_half_move = next_field(clocks);
+  if (!fen_half_move.empty() && fen_half_move[0] >= '0' &&
+      fen_half_move[0] <= '9') {
+    if (!parse_clock(fen_half_move, &half_move) ||
+        !parse_clock(next_field(clocks), &full_move)) {
+      return kFenBadClock;
+    }
+    fen = clocks;
+  }
+
+  if (rest) {
+    skip_whitespace(fen);
+    *rest = fen;
+  }
+
+  *board = Board(pieces, castling, side, ep_square, half_move, full_move);
+  return kFenOk;
+}
+
+size_t Board::parse_fens(std::string_view buffer, Board *boards,
+                         size_t capacity, FenError *error) {
+  size_t count = 0;
+  *error = kFenOk;
+  while (!buffer.empty() && count < capacity) {
+    const auto end = buffer.find('\n');
+    auto line = buffer.substr(0, end);
+    buffer.remove_prefix(end == std::string_view::npos ? buffer.size()
+                                                       : end + 1);
+
+    skip_whitespace(line);
+    if (line.empty()) {
+      continue;
+    }
+
+    *error = parse_fen(line, &boards[count]);
+    if (*error != kFenOk) {
+      break;
+    }
+    count++;
+  }
+
+  return count;
+}
+
+Board Board::from_fen(std::string_view fen) {
+  Board board;
+  if (parse_fen(fen, &board) != kFenOk) {
+    return null_board;
+  }
+
+  return board;
+}
+
+size_t Board::write_fen(char *out) const {
+  constexpr char piece_symbols[2][kNumPieces] = {
+      {'P', 'N', 'B', 'R', 'Q', 'K'},
+      {'p', 'n', 'b', 'r', 'q', 'k'},
+  };
+  constexpr char castle_symbols[] = {'K', 'Q', 'k', 'q'};
+
+  auto *cursor = out;
+  for (auto rank = 7; rank >= 0; --rank) {
+    if (rank < 7) {
+      *cursor++ = '/';
+    }
+
+    int empty = 0;
+    for (auto file = 0; file < 8; file++) {
+      const auto square = Square(file, rank);
+      const auto piece_type = piece_type_at(square);
+      if (piece_type == -1) {
+        empty++;
+        continue;
+      }
+
+      if (empty) {
+        *cursor++ = '0' + empty;
+        empty = 0;
+      }
+
+      const auto side = square_occupied(kSideWhite, square) ? kSideWhite
+                                                            : kSideBlack;
+      *cursor++ = piece_symbols[side][piece_type];
+    }
+
+    if (empty) {
+      *cursor++ = '0' + empty;
+    }
+  }
+
+  *cursor++ = ' ';
+  *cursor++ = side_ == kSideWhite ? 'w' : 'b';
+
+  *cursor++ = ' ';
+  if (!castling_) {
+    *cursor++ = '-';
+  }
+  for (int castle_side = 0; castle_side < kNumCastle; castle_side++) {
+    if (castling(castle_side)) {
+      *cursor++ = castle_symbols[castle_side];
+    }
+  }
+
+  *cursor++ = ' ';
+  if (ep_square_ == null_square) {
+    *cursor++ = '-';
+  } else {
+    *cursor++ = 'a' + ep_square_.file();
+    *cursor++ = '1' + ep_square_.rank();
+  }
+
+  *cursor++ = ' ';
+  cursor += write_number(half_move_, cursor);
+  *cursor++ = ' ';
+  cursor += write_number(full_move_, cursor);
+  *cursor = '\0';
+
+  return cursor - out;
+}
+
+std::string Board::fen() const {
+  char buffer[max_fen_length + 1];
+  return std::string(buffer, write_fen(buffer));
+}
+
+uint64_t Board::compute_key() const {
+  uint64_t key = 0;
+  for (auto side = 0; side < kNumSides; side++) {
+    for (auto piece_type = 0; piece_type < kNumPieces; piece_type++) {
+      BitboardIterator square_iter(piece_board(side, piece_type));
+      while (square_iter.has_data()) {
+        const auto square = square_iter.next();
+        key ^= zobrist_keys.pieces[side][piece_type][square.index()];
+      }
+    }
+  }
+
+  if (side_ == kSideBlack) {
+    key ^= zobrist_keys.side;
+  }
+
+  for (auto castle_side = 0; castle_side < kNumCastle; castle_side++) {
+    if (castling(castle_side)) {
+      key ^= zobrist_keys.castling[castle_side];
+    }
+  }
+
+  if (ep_square_ != null_square) {
+    key ^= zobrist_keys.ep_file[ep_square_.file()];
+  }
+
+  return key;
+}
+
+Bitboard Board::attacked_squares(int side) const {
+  const auto &occupied = this->occupied();
+
+  return pawn_attack_board(side, pawns(side)) |
+         knight_attack_board(knights(side)) |
+         bishop_attack_board(occupied, bishops(side)) |
+         rook_attack_board(occupied, rooks(side)) |
+         queen_attack_board(occupied, queens(side)) |
+         king_attack_board(kings(side));
+}
+
+} // namespace chess
@@ -0,0 +1,85 @@
+#include <cstdlib>
+
+#include <libchess/move.h>
+
+namespace chess {
+inline bool promotion_move(const Board &board, Square from, Square to) {
+  return board.pawns().occupied(from) && (to.rank() == 0 || to.rank() == 7);
+}
+
+size_t Move::write_uci(char *out) const {
+  constexpr char promotion_symbols[] = {'q', 'r', 'b', 'n'};
+
+  auto *cursor = out;
+  *cursor++ = 'a' + from().file();
+  *cursor++ = '1' + from().rank();
+  *cursor++ = 'a' + to().file();
+  *cursor++ = '1' + to().rank();
+  if (promotes()) {
+    *cursor++ = promotion_symbols[promotion()];
+  }
+  *cursor = '\0';
+
+  return cursor - out;
+}
+
+Move Move::from_uci(const Board &board, std::string_view uci) {
+  if (uci.size() != 4 && uci.size() != 5) {
+    return Move();
+  }
+
+  for (auto i = 0; i < 4; i += 2) {
+    if (uci[i] < 'a' || uci[i] > 'h' || uci[i + 1] < '1' || uci[i + 1] > '8') {
+      return Move();
+    }
+  }
+
+  const auto from = Square(uci[0] - 'a', uci[1] - '1');
+  const auto to = Square(uci[2] - 'a', uci[3] - '1');
+
+  auto promotion = kPromoteQueen;
+  if (uci.size() == 5) {
+    switch (uci[4]) {
+    case 'q':
+      promotion = kPromoteQueen;
+      break;
+    case 'r':
+      promotion = kPromoteRook;
+      break;
+    case 'b':
+      promotion = kPromoteBishop;
+      break;
+    case 'n':
+      promotion = kPromoteKnight;
+      break;
+    default:
+      return Move();
+    }
+
+    if (!promotion_move(board, from, to)) {
+      return Move();
+    }
+  }
+
+  const auto capture = board.square_occupied(!board.turn(), to);
+  if (promotion_move(board, from, to)) {
+    return Move(from, to, promotion, capture);
+  } else if (capture) {
+    return Move(from, to, kMoveCapture);
+  }
+
+  if (board.pawns().occupied(from)) {
+    if (to == board.ep_square()) {
+      return Move(from, to, kMoveEnPassant);
+    } else if (abs(to.index() - from.index()) == 16) {
+      return Move(from, to, kMoveDoublePush);
+    }
+  } else if (board.kings().occupied(from) &&
+             abs(to.file() - from.file()) == 2) {
+    return Move(from, to,
+                to.file() == 6 ? kMoveKingCastle : kMoveQueenCastle);
+  }
+
+  return Move(from, to);
+}
+} // namespace chess
@@ -1,317 +1,634 @@
-#include <libchess/bitboard_iterator.h>
-#include <libchess/move_generator.h>
-#include <libchess/piece.h>
-#include <libchess/square.h>
-
-namespace chess {
-
-void MoveGenerator::generate_pawn_moves(const Board &board, MoveList *moves) {
-  const auto &pawn_board = board.pawns();
-  const auto side = board.turn();
-  const auto &occupied = board.occupied();
-  const auto &enemy_occupied = board.occupied(!side);
-
-  BitboardIterator pawn_iter(pawn_board);
-  while (pawn_iter.has_data()) {
-    auto from = pawn_iter.next();
-
-    auto move_board = pawn_move_board(side, from) & ~occupied;
-    if (move_board.data()) {
-      move_board |= pawn_double_move_board(side, from) & ~occupied;
-    }
-
-    auto capture_board = pawn_attack_board(side, from) & enemy_occupied;
-
-    Bitboard ep_board = 0;
-    auto ep_square = board.ep_square();
-    if (ep_square != null_square) {
-      auto side_offset = side == 0 ? -1 : 1;
-      if (ep_square.offset(-1, side_offset) == from ||
-          ep_square.offset(1, side_offset) == from) {
-        ep_board.set(ep_square);
-      }
-    }
-
-    constexpr Promotion promotion_types[] = {kPromoteKnight, kPromoteBishop,
-                                             kPromoteRook, kPromoteQueen};
-    const auto promotion_rank = side == kSideWhite ? 7 : 0;
-
-    // Generate pushes
-    BitboardIterator push_iter(move_board);
-    while (push_iter.has_data()) {
-      auto to = push_iter.next();
-      if (to.rank() == promotion_rank) {
-        for (auto promote : promotion_types) {
-          moves->add_move(chess::Move(from, to, false, false, promote));
-        }
-      } else {
-        moves->add_move(chess::Move(from, to));
-      }
-    }
-
-    // Generate normal captures
-    BitboardIterator capture_iter(capture_board);
-    while (capture_iter.has_data()) {
-      auto to = capture_iter.next();
-      if (to.rank() == promotion_rank) {
-        for (auto promote : promotion_types) {
-          moves->add_move(chess::Move(from, to, true, false, promote));
-        }
-      } else {
-        moves->add_move(chess::Move(from, to, true));
-      }
-    }
-
-    // Generate en passant captures
-    BitboardIterator ep_iter(ep_board);
-    while (ep_iter.has_data()) {
-      auto to = ep_iter.next();
-      moves->add_move(chess::Move(from, to, true, true));
-    }
-  }
-}
-
-void MoveGenerator::generate_knight_moves(const Board &board, MoveList *moves) {
-  const auto &knight_board = board.knights();
-  const auto &enemy_occupied = board.occupied(!board.turn());
-  BitboardIterator knight_iter(knight_board);
-  while (knight_iter.has_data()) {
-    auto from = knight_iter.next();
-
-    auto dest_squares =
-        knight_attack_board(from) & ~board.occupied(board.turn());
-    BitboardIterator dest_iter(dest_squares);
-    while (dest_iter.has_data()) {
-      auto to = dest_iter.next();
-      bool capture = enemy_occupied.occupied(to);
-      moves->add_move(chess::Move(from, to, capture));
-    }
-  }
-}
-
-void generate_ray_moves(const Board &board, const Square from,
-                        const Bitboard attack_table, MoveList *moves) {
-
-  const auto &enemy_occupied = board.occupied(!board.turn());
-
-  // Filter out captures on our own pieces.
-  const auto attacked = attack_table & ~board.occupied(board.turn());
-
-  BitboardIterator attacked_iter(attacked);
-  while (attacked_iter.has_data()) {
-    auto to = attacked_iter.next();
-    const auto capture = enemy_occupied.occupied(to);
-    moves->add_move(chess::Move(from, to, capture));
-  }
-}
-
-void MoveGenerator::generate_bishop_moves(const Board &board, MoveList *moves) {
-  const auto &bishops = board.bishops();
-  const auto &occupied = board.occupied();
-
-  BitboardIterator bishop_iter(bishops);
-  while (bishop_iter.has_data()) {
-    auto from = bishop_iter.next();
-    const auto attacked = bishop_attack_board(occupied, from);
-    generate_ray_moves(board, from, attacked, moves);
-  }
-}
-
-void MoveGenerator::generate_rook_moves(const Board &board, MoveList *moves) {
-  const auto &rooks = board.rooks();
-  const auto &occupied = board.occupied();
-
-  BitboardIterator rook_iter(rooks);
-  while (rook_iter.has_data()) {
-    auto from = rook_iter.next();
-    const auto attacked = rook_attack_board(occupied, from);
-    generate_ray_moves(board, from, attacked, moves);
-  }
-}
-
-void MoveGenerator::generate_queen_moves(const Board &board, MoveList *moves) {
-  const auto &queens = board.queens();
-  const auto &occupied = board.occupied();
-
-  BitboardIterator queen_iter(queens);
-  while (queen_iter.has_data()) {
-    auto from = queen_iter.next();
-    const auto attacked = queen_attack_board(occupied, from);
-    generate_ray_moves(board, from, attacked, moves);
-  }
-}
-
-void MoveGenerator::generate_king_moves(const Board &board, MoveList *moves) {
-  const auto &kings = board.kings();
-  const auto &occupied = board.occupied(board.turn());
-  const auto &enemy_occupied = board.occupied(!board.turn());
-
-  BitboardIterator king_iter(kings);
-  while (king_iter.has_data()) {
-    auto from = king_iter.next();
-
-    const auto attacked = king_attack_board(from) & ~occupied;
-    BitboardIterator attack_iter(attacked);
-    while (attack_iter.has_data()) {
-      auto to = attack_iter.next();
-      const auto capture = enemy_occupied.occupied(to);
-      moves->add_move(chess::Move(from, to, capture));
-    }
-  }
-}
-
-void MoveGenerator::generate_castling_moves(chess::Game &game,
-                                            MoveList *moves) {
-  const auto &board = game.board();
-  const auto side = board.turn();
-  const auto &king_board = board.kings();
-
-  // G1, C1, G8, C8
-  const Square castle_squares[] = {Square(6, 0), Square(2, 0), Square(6, 7),
-                                   Square(2, 7)};
-  const Square king_squares[] = {Square(4, 0), Square(4, 7)};
-
-  // Generate every pseudolegal move for the opponent. We need this to find out
-  // which squares are attacked.
-  game.make_null_move();
-  auto opponent_moves = generate_pseudolegal_moves(board);
-  game.unmake_move();
-
-  Bitboard attacked = 0;
-  for (chess::Move move : opponent_moves.moves()) {
-    if (move.null()) {
-      break;
-    }
-
-    attacked.set(move.to());
-  }
-
-  if (side == kSideWhite) {
-    const Square white_kingside_castle_squares[] = {Square(5, 0), Square(6, 0)};
-    const Square white_queenside_castle_squares[] = {Square(1, 0), Square(2, 0),
-                                                     Square(3, 0)};
-
-    auto kingside_castle_safe = board.castling(kCastleWhiteKingSide);
-    auto queenside_castle_safe = board.castling(kCastleWhiteQueenSide);
-
-    if (kingside_castle_safe) {
-      for (auto square : white_kingside_castle_squares) {
-        if (board.square_occupied(square) || attacked.occupied(square)) {
-          kingside_castle_safe = false;
-          break;
-        }
-      }
-
-      if (!board.square_occupied(Square(7, 0))) {
-        kingside_castle_safe = false;
-      }
-    }
-
-    if (queenside_castle_safe) {
-      for (auto square : white_queenside_castle_squares) {
-        if (board.square_occupied(square) || attacked.occupied(square)) {
-          queenside_castle_safe = false;
-          break;
-        }
-      }
-
-      if (!board.square_occupied(Square(0, 0))) {
-        queenside_castle_safe = false;
-      }
-    }
-
-    if (kingside_castle_safe) {
-      moves->add_move(chess::Move(king_squares[side],
-                                  castle_squares[kCastleWhiteKingSide]));
-    }
-
-    if (queenside_castle_safe) {
-      moves->add_move(chess::Move(king_squares[side],
-                                  castle_squares[kCastleWhiteQueenSide]));
-    }
-  } else {
-    const Square black_kingside_castle_squares[] = {Square(5, 7), Square(6, 7)};
-    const Square black_queenside_castle_squares[] = {Square(1, 7), Square(2, 7),
-                                                     Square(3, 7)};
-    auto kingside_castle_safe = board.castling(kCastleBlackKingSide);
-    auto queenside_castle_safe = board.castling(kCastleBlackQueenSide);
-
-    if (kingside_castle_safe) {
-      for (auto square : black_kingside_castle_squares) {
-        if (board.square_occupied(square) || attacked.occupied(square)) {
-          kingside_castle_safe = false;
-          break;
-        }
-      }
-
-      if (!board.square_occupied(Square(7, 7))) {
-        kingside_castle_safe = false;
-      }
-    }
-
-    if (queenside_castle_safe) {
-      for (auto square : black_queenside_castle_squares) {
-        if (board.square_occupied(square) || attacked.occupied(square)) {
-          queenside_castle_safe = false;
-          break;
-        }
-      }
-
-      if (!board.square_occupied(Square(0, 7))) {
-        queenside_castle_safe = false;
-      }
-    }
-
-    if (kingside_castle_safe) {
-      moves->add_move(chess::Move(king_squares[side],
-                                  castle_squares[kCastleBlackKingSide]));
-    }
-
-    if (queenside_castle_safe) {
-      moves->add_move(chess::Move(king_squares[side],
-                                  castle_squares[kCastleBlackQueenSide]));
-    }
-  }
-}
-
-MoveList MoveGenerator::generate_pseudolegal_moves(const Board &board) {
-  MoveList moves;
-  generate_pawn_moves(board, &moves);
-  generate_knight_moves(board, &moves);
-  generate_bishop_moves(board, &moves);
-  generate_rook_moves(board, &moves);
-  generate_queen_moves(board, &moves);
-  generate_king_moves(board, &moves);
-  return moves;
-}
-
-MoveList MoveGenerator::generate_legal_moves(chess::Game &game) {
-  MoveList legal_moves;
-  const auto &board = game.board();
-  const auto in_check = board.check(board.turn());
-  const auto side = board.turn();
-
-  const auto pseudolegal_moves = generate_pseudolegal_moves(board);
-  const auto &moves_array = pseudolegal_moves.moves();
-  for (auto i = 0; i < pseudolegal_moves.size(); i++) {
-    const auto move = moves_array[i];
-
-    game.make_move(move);
-    auto check = board.check(side);
-    game.unmake_move();
-
-    if (check) {
-      continue;
-    }
-
-    legal_moves.add_move(move);
-  }
-
-  // Make sure we don't generate castle moves when in check.
-  if (!in_check) {
-    generate_castling_moves(game, &legal_moves);
-  }
-
-  return legal_moves;
-}
-} // namespace chess
\ No newline at end of file
+#include <initializer_list>
+
+#include <libchess/bitboard_iterator.h>
+#include <libchess/move_generator.h>
+#include <libchess/piece.h>
+#include <libchess/square.h>
+
+namespace chess {
+
+// Pieces of either side that are the only piece between |king| and a slider
+// of |side| aimed at it. Moving one of these uncovers an attack on the king.
+Bitboard slider_blockers(const Board &board, int side, Square king) {
+  const auto &occupied = board.occupied();
+  const auto bishops = board.bishops(side) | board.queens(side);
+  const auto rooks = board.rooks(side) | board.queens(side);
+
+  // Sliders that would attack the king on an empty board.
+  const auto snipers = (bishop_attack_board(0, king) & bishops) |
+                       (rook_attack_board(0, king) & rooks);
+
+  Bitboard blockers = 0;
+  BitboardIterator sniper_iter(snipers);
+  while (sniper_iter.has_data()) {
+    const auto between = between_board(king, sniper_iter.next()) & occupied;
+    if (between.count() == 1) {
+      blockers |= between;
+    }
+  }
+
+  return blockers;
+}
+
+// En passant removes two pawns from the same rank at once, which can expose
+// the king in ways the pin and check masks don't cover. Replay the capture on
+// the occupancy and look for anything attacking the king afterwards.
+template <Side side>
+bool en_passant_legal(const Board &board, Square from, Square to, Square king) {
+  const auto captured = Square(to.index() + (side == kSideWhite ? -8 : 8));
+
+  auto occupied = board.occupied();
+  occupied.unset(from);
+  occupied.unset(captured);
+  occupied.set(to);
+
+  auto attackers =
+      board.attackers_to(king, occupied) & board.occupied(!side);
+  attackers.unset(captured);
+  return !attackers.data();
+}
+
+// Squares a piece on |from| may move to, keeping pinned pieces on their pin
+// ray.
+inline Bitboard move_targets(const Square from, const Bitboard &targets,
+                             const Bitboard &pinned, const Square king) {
+  if (pinned.occupied(from)) {
+    return targets & line_board(king, from);
+  }
+
+  return targets;
+}
+
+// Squares a non-pawn move is allowed to land on in |mode|.
+template <Side side, GenerationMode mode>
+inline Bitboard mode_targets(const Board &board) {
+  if constexpr (mode == kCaptures) {
+    return board.occupied(!side);
+  } else if constexpr (mode == kQuiets || mode == kQuietChecks) {
+    return ~board.occupied();
+  } else {
+    return ~board.occupied(side);
+  }
+}
+
+template <GenerationMode mode>
+inline MoveFlag capture_flag(const Bitboard &enemy_occupied, const Square to) {
+  if constexpr (mode == kCaptures) {
+    return kMoveCapture;
+  } else if constexpr (mode == kQuiets || mode == kQuietChecks) {
+    return kMoveQuiet;
+  } else {
+    return enemy_occupied.occupied(to) ? kMoveCapture : kMoveQuiet;
+  }
+}
+
+template <int piece_type>
+inline Bitboard piece_attack_board(const Bitboard &occupied,
+                                   const Square from) {
+  if constexpr (piece_type == kPieceKnight) {
+    return knight_attack_board(from);
+  } else if constexpr (piece_type == kPieceBishop) {
+    return bishop_attack_board(occupied, from);
+  } else if constexpr (piece_type == kPieceRook) {
+    return rook_attack_board(occupied, from);
+  } else {
+    return queen_attack_board(occupied, from);
+  }
+}
+
+// Squares that give check when |piece_type| moves there from |from|, either
+// directly or by uncovering one of our sliders.
+inline Bitboard checking_targets(const Bitboard (&check_squares)[kNumPieces],
+                                 const Bitboard &discoverers,
+                                 const Square enemy_king, const int piece_type,
+                                 const Square from) {
+  if (discoverers.occupied(from)) {
+    return check_squares[piece_type] | ~line_board(enemy_king, from);
+  }
+
+  return check_squares[piece_type];
+}
+
+constexpr uint64_t file_a = 0x0101010101010101ull;
+constexpr uint64_t file_h = 0x8080808080808080ull;
+
+// Shifts every square on |board| by |delta| squares. Positive deltas move
+// towards the eighth rank.
+template <int delta> inline Bitboard shift(const Bitboard &board) {
+  if constexpr (delta > 0) {
+    return board << delta;
+  } else {
+    return board >> -delta;
+  }
+}
+
+// Adds a pawn move for every square on |targets|, coming from |delta| squares
+// behind it. Promotion flags expand into one move per promotion. Pinned pawns
+// may only move along their pin ray.
+inline void add_pawn_moves(const Bitboard &targets, const int delta,
+                           const MoveFlag flag, const Bitboard &pinned,
+                           const Square king, MoveList *moves) {
+  constexpr Promotion promotion_types[] = {kPromoteKnight, kPromoteBishop,
+                                           kPromoteRook, kPromoteQueen};
+
+  BitboardIterator target_iter(targets);
+  while (target_iter.has_data()) {
+    const auto to = target_iter.next();
+    const auto from = Square(to.index() - delta);
+    if (pinned.occupied(from) && !line_board(king, from).occupied(to)) {
+      continue;
+    }
+
+    if (flag & kMovePromotion) {
+      for (auto promote : promotion_types) {
+        moves->add_move(chess::Move(from, to, promote, flag & kMoveCapture));
+      }
+    } else {
+      moves->add_move(chess::Move(from, to, flag));
+    }
+  }
+}
+
+template <Side side, GenerationMode mode>
+void MoveGenerator::generate_pawn_moves(const Board &board,
+                                        const MoveMask &mask,
+                                        MoveList *moves) {
+  constexpr bool promotions = mode != kQuiets && mode != kQuietChecks;
+  constexpr bool pushes = mode != kCaptures;
+  constexpr bool captures = mode != kQuiets && mode != kQuietChecks;
+
+  constexpr int up = side == kSideWhite ? 8 : -8;
+  // Captures towards the A and H files.
+  constexpr int up_west = side == kSideWhite ? 7 : -9;
+  constexpr int up_east = side == kSideWhite ? 9 : -7;
+  // Pawns on the rank before last only promote, every other pawn never does.
+  constexpr uint64_t promoting_rank =
+      side == kSideWhite ? 0x00ff000000000000ull : 0x000000000000ff00ull;
+  // Where pawns land after a single push from their starting rank.
+  constexpr uint64_t double_push_rank =
+      side == kSideWhite ? 0x0000000000ff0000ull : 0x0000ff0000000000ull;
+
+  const auto pawn_board = board.pawns() & mask.sources;
+  const auto promoting = pawn_board & promoting_rank;
+  const auto other_pawns = pawn_board & ~promoting_rank;
+  const auto empty = ~board.occupied();
+  const auto &enemy_occupied = board.occupied(!side);
+  const auto targets = mask.destinations & mask.evasions;
+
+  if constexpr (pushes) {
+    auto single_pushes = shift<up>(other_pawns) & empty;
+    auto double_pushes = shift<up>(single_pushes & double_push_rank) & empty;
+    single_pushes &= targets;
+    double_pushes &= targets;
+
+    if constexpr (mode == kQuietChecks) {
+      // Pushes check the king directly, or uncover a check unless the pawn is
+      // on the king's file and stays on the line to it.
+      const auto king_file = Bitboard(file_a << mask.enemy_king.file());
+      const auto discoverers = mask.discoverers & ~king_file;
+      single_pushes &=
+          mask.check_squares[kPiecePawn] | shift<up>(discoverers);
+      double_pushes &=
+          mask.check_squares[kPiecePawn] | shift<up * 2>(discoverers);
+    }
+
+    add_pawn_moves(single_pushes, up, kMoveQuiet, mask.pinned, mask.king,
+                   moves);
+    add_pawn_moves(double_pushes, up * 2, kMoveDoublePush, mask.pinned,
+                   mask.king, moves);
+  }
+
+  if constexpr (promotions) {
+    if (promoting.data()) {
+      const auto push_promotions = shift<up>(promoting) & empty & targets;
+      const auto west_promotions =
+          shift<up_west>(promoting & ~file_a) & enemy_occupied & targets;
+      const auto east_promotions =
+          shift<up_east>(promoting & ~file_h) & enemy_occupied & targets;
+
+      add_pawn_moves(push_promotions, up, kMovePromotion, mask.pinned,
+                     mask.king, moves);
+      add_pawn_moves(west_promotions, up_west, kMovePromotionCapture,
+                     mask.pinned, mask.king, moves);
+      add_pawn_moves(east_promotions, up_east, kMovePromotionCapture,
+                     mask.pinned, mask.king, moves);
+    }
+  }
+
+  if constexpr (captures) {
+    const auto west_captures =
+        shift<up_west>(other_pawns & ~file_a) & enemy_occupied & targets;
+    const auto east_captures =
+        shift<up_east>(other_pawns & ~file_h) & enemy_occupied & targets;
+
+    add_pawn_moves(west_captures, up_west, kMoveCapture, mask.pinned,
+                   mask.king, moves);
+    add_pawn_moves(east_captures, up_east, kMoveCapture, mask.pinned,
+                   mask.king, moves);
+
+    const auto ep_square = board.ep_square();
+    if (ep_square != null_square && mask.destinations.occupied(ep_square)) {
+      const auto ep_pawns =
+          pawn_attack_board(!side, ep_square) & other_pawns;
+      BitboardIterator ep_iter(ep_pawns);
+      while (ep_iter.has_data()) {
+        const auto from = ep_iter.next();
+        if (mode == kPseudolegal || mask.king == null_square ||
+            en_passant_legal<side>(board, from, ep_square, mask.king)) {
+          moves->add_move(chess::Move(from, ep_square, kMoveEnPassant));
+        }
+      }
+    }
+  }
+}
+
+template <Side side, GenerationMode mode, int piece_type>
+void MoveGenerator::generate_piece_moves(const Board &board,
+                                         const MoveMask &mask,
+                                         MoveList *moves) {
+  auto piece_board = board.piece_board(side, piece_type) & mask.sources;
+  if constexpr (piece_type == kPieceKnight) {
+    // A pinned knight can never stay on its pin ray.
+    piece_board &= ~mask.pinned;
+  }
+
+  const auto &occupied = board.occupied();
+  const auto &enemy_occupied = board.occupied(!side);
+  const auto targets =
+      mask.destinations & mask.evasions & mode_targets<side, mode>(board);
+
+  BitboardIterator piece_iter(piece_board);
+  while (piece_iter.has_data()) {
+    auto from = piece_iter.next();
+
+    auto attacked = piece_attack_board<piece_type>(occupied, from) &
+                    move_targets(from, targets, mask.pinned, mask.king);
+    if constexpr (mode == kQuietChecks) {
+      attacked &= checking_targets(mask.check_squares, mask.discoverers,
+                                   mask.enemy_king, piece_type, from);
+    }
+
+    BitboardIterator attacked_iter(attacked);
+    while (attacked_iter.has_data()) {
+      auto to = attacked_iter.next();
+      const auto flag = capture_flag<mode>(enemy_occupied, to);
+      moves->add_move(chess::Move(from, to, flag));
+    }
+  }
+}
+
+template <Side side, GenerationMode mode>
+void MoveGenerator::generate_king_moves(const Board &board,
+                                        const MoveMask &mask,
+                                        MoveList *moves) {
+  const auto kings = board.kings(side) & mask.sources;
+  const auto &enemy_occupied = board.occupied(!side);
+  const auto targets = mask.destinations & mode_targets<side, mode>(board);
+
+  // Sliders keep attacking through the king's current square, so take the
+  // king off the board before testing where it can go.
+  const auto occupied_without_king = board.occupied() & ~board.kings(side);
+
+  BitboardIterator king_iter(kings);
+  while (king_iter.has_data()) {
+    auto from = king_iter.next();
+
+    auto attacked = king_attack_board(from) & targets;
+    if constexpr (mode == kQuietChecks) {
+      // A king can only give check by discovery.
+      attacked &= checking_targets(mask.check_squares, mask.discoverers,
+                                   mask.enemy_king, kPieceKing, from);
+    }
+
+    BitboardIterator attack_iter(attacked);
+    while (attack_iter.has_data()) {
+      auto to = attack_iter.next();
+      if (mode != kPseudolegal &&
+          (board.attackers_to(to, occupied_without_king) & enemy_occupied)
+              .data()) {
+        continue;
+      }
+
+      const auto flag = capture_flag<mode>(enemy_occupied, to);
+      moves->add_move(chess::Move(from, to, flag));
+    }
+  }
+}
+
+// Squares involved in each castle, indexed by CastlingRights.
+struct CastlePath {
+  Square king;
+  Square king_to;
+  Square rook;
+  // Squares between the king and the rook. These must all be empty.
+  Bitboard empty;
+  // Squares the king passes through or lands on. None of these may be
+  // attacked.
+  Bitboard safe;
+};
+
+const CastlePath castle_paths[kNumCastle] = {
+    // E1 -> G1, F1 and G1 empty and safe.
+    {Square(4, 0), Square(6, 0), Square(7, 0), 0x0000000000000060ull,
+     0x0000000000000060ull},
+    // E1 -> C1, B1 through D1 empty, only C1 and D1 need to be safe.
+    {Square(4, 0), Square(2, 0), Square(0, 0), 0x000000000000000eull,
+     0x000000000000000cull},
+    // E8 -> G8
+    {Square(4, 7), Square(6, 7), Square(7, 7), 0x6000000000000000ull,
+     0x6000000000000000ull},
+    // E8 -> C8
+    {Square(4, 7), Square(2, 7), Square(0, 7), 0x0e00000000000000ull,
+     0x0c00000000000000ull},
+};
+
+template <Side side>
+void MoveGenerator::generate_castling_moves(const Board &board,
+                                            const MoveMask &mask,
+                                            MoveList *moves) {
+  constexpr int first_castle =
+      side == kSideWhite ? kCastleWhiteKingSide : kCastleBlackKingSide;
+  const auto kings = board.kings(side) & mask.sources;
+
+  // Only build the opponent's attack map once a castle is otherwise possible.
+  Bitboard attacked = 0;
+  bool attacked_computed = false;
+
+  for (int castle = first_castle; castle < first_castle + 2; castle++) {
+    const auto &path = castle_paths[castle];
+    if (!board.castling(castle) || !kings.occupied(path.king) ||
+        !board.rooks(side).occupied(path.rook) ||
+        !mask.destinations.occupied(path.king_to)) {
+      continue;
+    }
+
+    if ((board.occupied() & path.empty).data()) {
+      continue;
+    }
+
+    if (!attacked_computed) {
+      attacked = board.attacked_squares(!side);
+      attacked_computed = true;
+    }
+
+    if ((attacked & path.safe).data()) {
+      continue;
+    }
+
+    // King side castles have even indices.
+    moves->add_move(chess::Move(path.king, path.king_to,
+                                MoveFlag(kMoveKingCastle + (castle & 1))));
+  }
+}
+
+template <Side side, GenerationMode mode>
+void MoveGenerator::generate_moves(const Board &board, const MoveMask &mask,
+                                   MoveList *moves) {
+  generate_pawn_moves<side, mode>(board, mask, moves);
+  generate_piece_moves<side, mode, kPieceKnight>(board, mask, moves);
+  generate_piece_moves<side, mode, kPieceBishop>(board, mask, moves);
+  generate_piece_moves<side, mode, kPieceRook>(board, mask, moves);
+  generate_piece_moves<side, mode, kPieceQueen>(board, mask, moves);
+  generate_king_moves<side, mode>(board, mask, moves);
+
+  // Make sure we don't generate castle moves when in check.
+  if constexpr (mode == kQuiets || mode == kLegal) {
+    if (!mask.checkers.data()) {
+      generate_castling_moves<side>(board, mask, moves);
+    }
+  }
+}
+
+// Number of pawn moves from |pawns| to |targets|, counting each promotion
+// separately. En passant is left to the caller.
+template <Side side>
+inline int count_pawn_moves(const Bitboard &pawns, const Bitboard &empty,
+                            const Bitboard &enemy_occupied,
+                            const Bitboard &targets) {
+  constexpr int up = side == kSideWhite ? 8 : -8;
+  constexpr int up_west = side == kSideWhite ? 7 : -9;
+  constexpr int up_east = side == kSideWhite ? 9 : -7;
+  constexpr uint64_t promotion_rank =
+      side == kSideWhite ? 0xff00000000000000ull : 0x00000000000000ffull;
+  constexpr uint64_t double_push_rank =
+      side == kSideWhite ? 0x0000000000ff0000ull : 0x0000ff0000000000ull;
+
+  const auto single_pushes = shift<up>(pawns) & empty;
+  const auto double_pushes =
+      shift<up>(single_pushes & double_push_rank) & empty & targets;
+  const auto west_captures =
+      shift<up_west>(pawns & ~file_a) & enemy_occupied & targets;
+  const auto east_captures =
+      shift<up_east>(pawns & ~file_h) & enemy_occupied & targets;
+
+  auto count = double_pushes.count();
+  for (const auto &moves : {single_pushes & targets, west_captures,
+                            east_captures}) {
+    count += (moves & ~promotion_rank).count() +
+             (moves & promotion_rank).count() * 4;
+  }
+  return count;
+}
+
+template <Side side>
+int MoveGenerator::count_moves(const Board &board, const MoveMask &mask) {
+  const auto &occupied = board.occupied();
+  const auto &enemy_occupied = board.occupied(!side);
+  const auto empty = ~occupied;
+  const auto targets = mask.destinations & mask.evasions;
+  const auto pieces = board.occupied(side) & mask.sources;
+
+  // Unpinned pawns are counted all at once, pinned ones along their pin ray.
+  const auto pawns = board.pawns(side) & pieces;
+  auto count =
+      count_pawn_moves<side>(pawns & ~mask.pinned, empty, enemy_occupied,
+                             targets);
+  BitboardIterator pinned_iter(pawns & mask.pinned);
+  while (pinned_iter.has_data()) {
+    const auto from = pinned_iter.next();
+    count += count_pawn_moves<side>(Bitboard(1ull << from.index()), empty,
+                                    enemy_occupied,
+                                    targets & line_board(mask.king, from));
+  }
+
+  const auto ep_square = board.ep_square();
+  if (ep_square != null_square && mask.destinations.occupied(ep_square)) {
+    BitboardIterator ep_iter(pawn_attack_board(!side, ep_square) & pawns);
+    while (ep_iter.has_data()) {
+      const auto from = ep_iter.next();
+      count += mask.king == null_square ||
+               en_passant_legal<side>(board, from, ep_square, mask.king);
+    }
+  }
+
+  // A pinned knight can never stay on its pin ray.
+  BitboardIterator knight_iter(board.knights(side) & pieces & ~mask.pinned);
+  while (knight_iter.has_data()) {
+    count += (knight_attack_board(knight_iter.next()) & targets).count();
+  }
+
+  const auto diagonal = (board.bishops(side) | board.queens(side)) & pieces;
+  BitboardIterator diagonal_iter(diagonal);
+  while (diagonal_iter.has_data()) {
+    const auto from = diagonal_iter.next();
+    count += (bishop_attack_board(occupied, from) &
+              move_targets(from, targets, mask.pinned, mask.king))
+                 .count();
+  }
+
+  const auto straight = (board.rooks(side) | board.queens(side)) & pieces;
+  BitboardIterator straight_iter(straight);
+  while (straight_iter.has_data()) {
+    const auto from = straight_iter.next();
+    count += (rook_attack_board(occupied, from) &
+              move_targets(from, targets, mask.pinned, mask.king))
+                 .count();
+  }
+
+  // King moves have to be checked square by square, and castling is rare
+  // enough to generate.
+  MoveList king_moves;
+  generate_king_moves<side, kLegal>(board, mask, &king_moves);
+  if (!mask.checkers.data()) {
+    generate_castling_moves<side>(board, mask, &king_moves);
+  }
+  return count + king_moves.size();
+}
+
+template <Side side, GenerationMode mode>
+MoveGenerator::MoveMask MoveGenerator::move_mask(const Board &board) {
+  const auto &kings = board.kings(side);
+
+  MoveMask mask;
+  mask.sources = board.occupied(side);
+  mask.destinations = ~board.occupied(side);
+  mask.evasions = ~0ull;
+  mask.checkers = 0;
+  mask.pinned = 0;
+  mask.king = null_square;
+
+  // Without a king every pseudolegal move is legal.
+  if (mode == kPseudolegal || !kings.data()) {
+    return mask;
+  }
+
+  mask.king = kings.find_first();
+  mask.pinned =
+      slider_blockers(board, !side, mask.king) & board.occupied(side);
+  mask.checkers = board.attackers_to(mask.king) & board.occupied(!side);
+
+  if (mask.checkers.count() > 1) {
+    // Only the king can get out of a double check.
+    mask.sources &= kings;
+    mask.evasions = 0;
+  } else if (mask.checkers.data()) {
+    // Any other piece has to capture the checker or block its ray.
+    const Square checker = mask.checkers.find_first();
+    mask.evasions = between_board(mask.king, checker) | mask.checkers;
+  }
+
+  if constexpr (mode == kQuietChecks) {
+    const auto &occupied = board.occupied();
+    const auto &enemy_kings = board.kings(!side);
+    if (!enemy_kings.data()) {
+      mask.sources = 0;
+      return mask;
+    }
+
+    const Square enemy_king = enemy_kings.find_first();
+    const auto bishop_checks = bishop_attack_board(occupied, enemy_king);
+    const auto rook_checks = rook_attack_board(occupied, enemy_king);
+    mask.check_squares[kPiecePawn] = pawn_attack_board(!side, enemy_king);
+    mask.check_squares[kPieceKnight] = knight_attack_board(enemy_king);
+    mask.check_squares[kPieceBishop] = bishop_checks;
+    mask.check_squares[kPieceRook] = rook_checks;
+    mask.check_squares[kPieceQueen] = bishop_checks | rook_checks;
+    mask.check_squares[kPieceKing] = 0;
+    mask.discoverers =
+        slider_blockers(board, side, enemy_king) & board.occupied(side);
+    mask.enemy_king = enemy_king;
+  }
+
+  return mask;
+}
+
+template <GenerationMode mode>
+void MoveGenerator::generate(const Board &board, MoveList *moves) {
+  if (board.turn() == kSideWhite) {
+    generate_moves<kSideWhite, mode>(
+        board, move_mask<kSideWhite, mode>(board), moves);
+  } else {
+    generate_moves<kSideBlack, mode>(
+        board, move_mask<kSideBlack, mode>(board), moves);
+  }
+}
+
+template <GenerationMode mode>
+MoveList MoveGenerator::generate(const Board &board) {
+  MoveList moves;
+  generate<mode>(board, &moves);
+  return moves;
+}
+
+template MoveList MoveGenerator::generate<kCaptures>(const Board &board);
+template MoveList MoveGenerator::generate<kQuiets>(const Board &board);
+template MoveList MoveGenerator::generate<kEvasions>(const Board &board);
+template MoveList MoveGenerator::generate<kQuietChecks>(const Board &board);
+template MoveList MoveGenerator::generate<kLegal>(const Board &board);
+template MoveList MoveGenerator::generate<kPseudolegal>(const Board &board);
+template void MoveGenerator::generate<kCaptures>(const Board &board,
+                                                 MoveList *moves);
+template void MoveGenerator::generate<kQuiets>(const Board &board,
+                                               MoveList *moves);
+template void MoveGenerator::generate<kEvasions>(const Board &board,
+                                                 MoveList *moves);
+template void MoveGenerator::generate<kQuietChecks>(const Board &board,
+                                                    MoveList *moves);
+template void MoveGenerator::generate<kLegal>(const Board &board,
+                                              MoveList *moves);
+template void MoveGenerator::generate<kPseudolegal>(const Board &board,
+                                                    MoveList *moves);
+
+MoveList MoveGenerator::generate_pseudolegal_moves(const Board &board) {
+  return generate<kPseudolegal>(board);
+}
+
+MoveList MoveGenerator::generate_legal_moves(const chess::Game &game) {
+  return generate<kLegal>(game.board());
+}
+
+MoveList MoveGenerator::generate_legal_moves(const Board &board) {
+  return generate<kLegal>(board);
+}
+
+template <Side side>
+void MoveGenerator::generate_single_move(const Board &board, const Move move,
+                                         MoveList *moves) {
+  auto mask = move_mask<side, kLegal>(board);
+  mask.sources &= Bitboard(1ull << move.from().index());
+  mask.destinations &= Bitboard(1ull << move.to().index());
+  generate_moves<side, kLegal>(board, mask, moves);
+}
+
+int MoveGenerator::count_legal_moves(const Board &board) {
+  if (board.turn() == kSideWhite) {
+    return count_moves<kSideWhite>(board, move_mask<kSideWhite, kLegal>(board));
+  } else {
+    return count_moves<kSideBlack>(board, move_mask<kSideBlack, kLegal>(board));
+  }
+}
+
+bool MoveGenerator::legal(const Board &board, const Move move) {
+  if (move.null()) {
+    return false;
+  }
+
+  MoveList moves;
+  if (board.turn() == kSideWhite) {
+    generate_single_move<kSideWhite>(board, move, &moves);
+  } else {
+    generate_single_move<kSideBlack>(board, move, &moves);
+  }
+  return moves.contains(move);
+}
+} // namespace chess
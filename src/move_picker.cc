@@ -0,0 +1,103 @@
+#include <libchess/move_picker.h>
+
+namespace chess {
+
+MovePicker::MovePicker(const Board &board, const Move best_move,
+                       const Move first_killer, const Move second_killer)
+    : board_(board), best_move_(best_move),
+      killers_{first_killer, second_killer}, killer_index_(0),
+      phase_(kPhaseBestMove), index_(0) {}
+
+template <GenerationMode mode> void MovePicker::load() {
+  moves_.clear();
+  generator_.generate<mode>(board_, &moves_);
+  index_ = 0;
+}
+
+void MovePicker::score_captures() {
+  const auto side = board_.turn();
+
+  for (auto i = 0; i < moves_.size(); i++) {
+    const auto move = moves_.move(i);
+    // Promotions are generated along with captures but go after all of them,
+    // queens first.
+    if (move.promotes()) {
+      moves_.set_score(i, -kNumPieces * 2 + move.promotion_piece_type() * 2 +
+                              move.capture());
+      continue;
+    }
+
+    const auto victim = move.en_passant()
+                            ? kPiecePawn
+                            : board_.piece_type_at(!side, move.to());
+    const auto attacker = board_.piece_type_at(side, move.from());
+    moves_.set_score(i, victim * kNumPieces + (kNumPieces - 1 - attacker));
+  }
+}
+
+bool MovePicker::returned_early(const Move move) const {
+  return move == best_move_ || move == killers_[0] || move == killers_[1];
+}
+
+Move MovePicker::next() {
+  while (true) {
+    switch (phase_) {
+    case kPhaseBestMove:
+      phase_ = kPhaseGenerateCaptures;
+      if (generator_.legal(board_, best_move_)) {
+        return best_move_;
+      }
+      // The best move is never returned twice, so forget an illegal one.
+      best_move_ = Move();
+      break;
+
+    case kPhaseGenerateCaptures:
+      load<kCaptures>();
+      score_captures();
+      phase_ = kPhaseCaptures;
+      break;
+
+    case kPhaseCaptures:
+      while (index_ < moves_.size()) {
+        const auto move = moves_.pick_best(index_++);
+        if (move != best_move_) {
+          return move;
+        }
+      }
+      phase_ = kPhaseGenerateQuiets;
+      break;
+
+    case kPhaseGenerateQuiets:
+      load<kQuiets>();
+      phase_ = kPhaseKillers;
+      break;
+
+    case kPhaseKillers:
+      // Killers come from sibling positions, so only return them if they're
+      // legal quiet moves here.
+      while (killer_index_ < 2) {
+        const auto killer = killers_[killer_index_++];
+        if (killer != best_move_ && moves_.contains(killer) &&
+            (killer_index_ == 1 || killer != killers_[0])) {
+          return killer;
+        }
+      }
+      phase_ = kPhaseQuiets;
+      break;
+
+    case kPhaseQuiets:
+      while (index_ < moves_.size()) {
+        const auto move = moves_.move(index_++);
+        if (!returned_early(move)) {
+          return move;
+        }
+      }
+      phase_ = kPhaseDone;
+      break;
+
+    case kPhaseDone:
+      return Move();
+    }
+  }
+}
+} // namespace chess
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <libchess/move_generator.h>
+#include <libchess/perft.h>
+
+namespace chess {
+PerftCache::PerftCache(size_t megabytes) {
+  size_t size = 1;
+  while (size * 2 * sizeof(Entry) <= megabytes << 20) {
+    size *= 2;
+  }
+
+  // Value initialized, so every entry starts out zero and fails to verify
+  // against any real key and depth.
+  entries_.reset(new Entry[size]());
+  mask_ = size - 1;
+}
+
+bool PerftCache::probe(uint64_t key, int depth, uint64_t *nodes) const {
+  const auto &entry = entries_[key & mask_];
+  const auto data = entry.data.load(std::memory_order_relaxed);
+  const auto check = entry.check.load(std::memory_order_relaxed);
+  if ((check ^ data) != key || (data & 0xff) != static_cast<uint64_t>(depth)) {
+    return false;
+  }
+
+  *nodes = data >> 8;
+  return true;
+}
+
+void PerftCache::store(uint64_t key, int depth, uint64_t nodes) {
+  auto &entry = entries_[key & mask_];
+  const auto data = nodes << 8 | static_cast<uint64_t>(depth);
+  entry.check.store(key ^ data, std::memory_order_relaxed);
+  entry.data.store(data, std::memory_order_relaxed);
+}
+
+uint64_t perft(const Board &board, int depth, PerftCache *cache) {
+  if (depth == 0) {
+    return 1;
+  }
+
+  uint64_t nodes = 0;
+  if (depth > 1 && cache && cache->probe(board.key(), depth, &nodes)) {
+    return nodes;
+  }
+
+  // Leaves are counted in bulk, without making their moves.
+  MoveGenerator generator;
+  if (depth == 1) {
+    return generator.count_legal_moves(board);
+  }
+
+  for (const auto move : generator.generate_legal_moves(board)) {
+    nodes += perft(board.after(move), depth - 1, cache);
+  }
+
+  if (cache) {
+    cache->store(board.key(), depth, nodes);
+  }
+  return nodes;
+}
+
+namespace {
+// A subtree waiting to be counted.
+struct PerftTask {
+  Board board;
+  int depth;
+};
+
+// Runs a single parallel_perft(). Every thread owns a deque of subtrees. It
+// takes work from the back of its own deque, and once that's empty, steals
+// from the front of the others', where the biggest subtrees are.
+class PerftPool {
+public:
+  PerftPool(int num_threads, PerftCache *cache, int split_depth)
+      : workers_(num_threads), cache_(cache), split_depth_(split_depth) {}
+
+  uint64_t run(const Board &board, int depth);
+
+private:
+  // Padded to a cache line so threads don't contend over each other's counts.
+  struct alignas(64) Worker {
+    std::mutex mutex;
+    std::deque<PerftTask> tasks;
+    uint64_t nodes = 0;
+  };
+
+  void work(int index);
+  // Counts the subtree below |board|. Whenever another thread is idle, the
+  // moves not yet searched are pushed for it to steal instead. |complete| is
+  // cleared if that happened anywhere in the subtree, since the count
+  // returned is then partial and mustn't be cached.
+  uint64_t search(int index, const Board &board, int depth, bool *complete);
+  void push(int index, const Board &board, int depth);
+  bool pop(int index, PerftTask *task);
+  bool steal(int index, PerftTask *task);
+
+  std::vector<Worker> workers_;
+  PerftCache *cache_;
+  int split_depth_;
+  // Subtrees pushed but not yet counted. The run is over once none are left.
+  std::atomic<int64_t> pending_{0};
+  // Threads that found no work on their last look.
+  std::atomic<int> idle_{0};
+};
+
+uint64_t PerftPool::run(const Board &board, int depth) {
+  push(0, board, depth);
+
+  std::vector<std::thread> threads;
+  for (auto i = 1; i < static_cast<int>(workers_.size()); i++) {
+    threads.emplace_back(&PerftPool::work, this, i);
+  }
+  work(0);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  uint64_t nodes = 0;
+  for (const auto &worker : workers_) {
+    nodes += worker.nodes;
+  }
+  return nodes;
+}
+
+void PerftPool::work(int index) {
+  auto &worker = workers_[index];
+  auto idle = false;
+  PerftTask task;
+  while (pending_.load() > 0) {
+    if (pop(index, &task) || steal(index, &task)) {
+      if (idle) {
+        idle_--;
+        idle = false;
+      }
+
+      auto complete = true;
+      worker.nodes += search(index, task.board, task.depth, &complete);
+      // Only after any subtrees split off above were pushed, so pending_
+      // can't reach zero while work remains.
+      pending_--;
+    } else {
+      if (!idle) {
+        idle_++;
+        idle = true;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  if (idle) {
+    idle_--;
+  }
+}
+
+uint64_t PerftPool::search(int index, const Board &board, int depth,
+                           bool *complete) {
+  if (depth <= split_depth_) {
+    return perft(board, depth, cache_);
+  }
+
+  uint64_t nodes = 0;
+  if (cache_ && cache_->probe(board.key(), depth, &nodes)) {
+    return nodes;
+  }
+
+  MoveGenerator generator;
+  const auto moves = generator.generate_legal_moves(board);
+  auto subtree_complete = true;
+  auto i = 0;
+  for (; i < moves.size() && idle_.load(std::memory_order_relaxed) == 0; i++) {
+    nodes += search(index, board.after(moves.move(i)), depth - 1,
+                    &subtree_complete);
+  }
+
+  for (auto j = i; j < moves.size(); j++) {
+    push(index, board.after(moves.move(j)), depth - 1);
+  }
+
+  if (i < moves.size() || !subtree_complete) {
+    *complete = false;
+  } else if (cache_) {
+    cache_->store(board.key(), depth, nodes);
+  }
+  return nodes;
+}
+
+void PerftPool::push(int index, const Board &board, int depth) {
+  pending_++;
+
+  auto &worker = workers_[index];
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  worker.tasks.push_back({board, depth});
+}
+
+bool PerftPool::pop(int index, PerftTask *task) {
+  auto &worker = workers_[index];
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  if (worker.tasks.empty()) {
+    return false;
+  }
+
+  *task = worker.tasks.back();
+  worker.tasks.pop_back();
+  return true;
+}
+
+bool PerftPool::steal(int index, PerftTask *task) {
+  const auto num_workers = static_cast<int>(workers_.size());
+  for (auto offset = 1; offset < num_workers; offset++) {
+    auto &victim = workers_[(index + offset) % num_workers];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      *task = victim.tasks.front();
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
+} // namespace
+
+uint64_t parallel_perft(const Board &board, int depth, int num_threads,
+                        PerftCache *cache, int split_depth) {
+  if (num_threads <= 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  if (num_threads == 1 || depth <= split_depth) {
+    return perft(board, depth, cache);
+  }
+
+  PerftPool pool(num_threads, cache, split_depth);
+  return pool.run(board, depth);
+}
+
+std::vector<PerftDivision> perft_divide(const Board &board, int depth,
+                                        int num_threads, PerftCache *cache) {
+  MoveGenerator generator;
+  std::vector<PerftDivision> divisions;
+  for (const auto move : generator.generate_legal_moves(board)) {
+    const auto nodes =
+        parallel_perft(board.after(move), depth - 1, num_threads, cache);
+    divisions.push_back({move, nodes});
+  }
+
+  return divisions;
+}
+} // namespace chess
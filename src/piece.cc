@@ -1,348 +1,498 @@
-#include <array>
-#include <tuple>
-
-#include <libchess/bitboard_iterator.h>
-#include <libchess/board.h>
-#include <libchess/piece.h>
-
-namespace chess {
-
-const std::array<std::array<Bitboard, 64>, kNumSides>
-compute_pawn_move_tables() {
-  std::array<std::array<Bitboard, 64>, kNumSides> move_tables;
-  for (auto side = 0; side < kNumSides; side++) {
-    const auto direction = side == 0 ? 1 : -1;
-    std::array<Bitboard, 64> moves;
-    for (Square square = 0; square < 64; square++) {
-      auto file = square.file();
-      auto rank = square.rank();
-      Bitboard board = 0;
-
-      auto rank_offset = rank + direction;
-      if (rank_offset < 0 || rank_offset > 7)
-        continue;
-
-      board.set(Square(file, rank_offset));
-      moves[square.index()] = board;
-    }
-
-    move_tables[side] = moves;
-  }
-
-  return move_tables;
-}
-
-const std::array<std::array<Bitboard, 64>, kNumSides>
-compute_pawn_double_move_tables() {
-  std::array<std::array<Bitboard, 64>, kNumSides> move_tables;
-  for (auto side = 0; side < kNumSides; side++) {
-    const auto direction = side == 0 ? 2 : -2;
-    const auto double_move_rank = side == chess::kSideWhite ? 1 : 6;
-    std::array<Bitboard, 64> moves;
-    for (Square square = 0; square < 64; square++) {
-      Bitboard board = 0;
-
-      if (square.rank() == double_move_rank) {
-        board.set(Square(square.file(), double_move_rank + direction));
-      }
-
-      moves[square.index()] = board;
-    }
-
-    move_tables[side] = moves;
-  }
-
-  return move_tables;
-}
-
-const std::array<std::array<Bitboard, 64>, kNumSides>
-compute_pawn_capture_tables() {
-  constexpr int offsets[] = {-1, 1};
-
-  std::array<std::array<Bitboard, 64>, kNumSides> capture_tables;
-  for (auto side = 0; side < kNumSides; side++) {
-    auto direction = side == 0 ? 1 : -1;
-    std::array<Bitboard, 64> moves;
-    for (Square square = 0; square < 64; square++) {
-      auto file = square.file();
-      auto rank = square.rank();
-      Bitboard board = 0;
-
-      for (auto offset : offsets) {
-        auto file_offset = file + offset;
-        auto rank_offset = rank + direction;
-        if (file_offset < 0 || file_offset > 7)
-          continue;
-        if (rank_offset < 0 || rank_offset > 7)
-          continue;
-        board.set(Square(file_offset, rank_offset));
-      }
-
-      moves[square.index()] = board;
-    }
-
-    capture_tables[side] = moves;
-  }
-
-  return capture_tables;
-}
-
-const std::array<Bitboard, 64> compute_knight_table() {
-  constexpr std::tuple<int, int> offsets[] = {
-      {-2, 1}, {-1, 2}, {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}};
-  std::array<Bitboard, 64> moves = {0};
-  for (Square square = 0; square < 64; square++) {
-    auto file = square.file();
-    auto rank = square.rank();
-    Bitboard board = 0;
-
-    for (auto offset : offsets) {
-      auto file_offset = file + std::get<0>(offset);
-      auto rank_offset = rank + std::get<1>(offset);
-      if (file_offset < 0 || file_offset > 7)
-        continue;
-      if (rank_offset < 0 || rank_offset > 7)
-        continue;
-      board.set(Square(file_offset, rank_offset));
-    }
-
-    moves[square.index()] = board;
-  }
-
-  return moves;
-}
-
-const std::array<Bitboard, 64> compute_king_table() {
-  constexpr std::tuple<int, int> offsets[] = {
-      {-1, -1}, {-1, 0}, {-1, 1}, {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}};
-  std::array<Bitboard, 64> moves = {0};
-  for (Square square = 0; square < 64; square++) {
-    auto file = square.file();
-    auto rank = square.rank();
-    Bitboard board = 0;
-
-    for (auto offset : offsets) {
-      auto file_offset = file + std::get<0>(offset);
-      auto rank_offset = rank + std::get<1>(offset);
-      if (file_offset < 0 || file_offset > 7)
-        continue;
-      if (rank_offset < 0 || rank_offset > 7)
-        continue;
-      board.set(Square(file_offset, rank_offset));
-    }
-
-    moves[square.index()] = board;
-  }
-
-  return moves;
-}
-
-template <int file_offset, int rank_offset>
-const std::array<Bitboard, 64> compute_ray_table() {
-  std::array<Bitboard, 64> moves = {0};
-  for (Square square = 0; square < 64; square++) {
-    Bitboard board = 0;
-    auto file = square.file() + file_offset;
-    auto rank = square.rank() + rank_offset;
-
-    while (true) {
-      if (file < 0 || file > 7)
-        break;
-      if (rank < 0 || rank > 7)
-        break;
-
-      board.set(Square(file, rank));
-
-      file += file_offset;
-      rank += rank_offset;
-    }
-
-    moves[square.index()] = board;
-  }
-
-  return moves;
-}
-
-// Attack look up tables. Saves a few cycles not having to compute these at
-// runtime.
-const std::array<std::array<Bitboard, 64>, kNumSides> pawn_move_tables =
-    compute_pawn_move_tables();
-const std::array<std::array<Bitboard, 64>, kNumSides> pawn_double_move_tables =
-    compute_pawn_double_move_tables();
-const std::array<std::array<Bitboard, 64>, kNumSides> pawn_capture_tables =
-    compute_pawn_capture_tables();
-const std::array<Bitboard, 64> knight_attack_table = compute_knight_table();
-const std::array<Bitboard, 64> king_attack_table = compute_king_table();
-
-// Lookup tables for bishop/rook/queen directional attacks
-const std::array<Bitboard, 64> ray_n_table = compute_ray_table<0, 1>();
-const std::array<Bitboard, 64> ray_e_table = compute_ray_table<1, 0>();
-const std::array<Bitboard, 64> ray_s_table = compute_ray_table<0, -1>();
-const std::array<Bitboard, 64> ray_w_table = compute_ray_table<-1, 0>();
-
-const std::array<Bitboard, 64> ray_nw_table = compute_ray_table<-1, 1>();
-const std::array<Bitboard, 64> ray_ne_table = compute_ray_table<1, 1>();
-const std::array<Bitboard, 64> ray_se_table = compute_ray_table<1, -1>();
-const std::array<Bitboard, 64> ray_sw_table = compute_ray_table<-1, -1>();
-
-template <bool generate_diagonal_rays, bool generate_orthogonal_rays>
-inline Bitboard ray_attack_table(const Bitboard occupied, const Square from) {
-  Bitboard attacked = 0;
-  Bitboard blockers = 0;
-  Square blocking_square;
-
-  if (generate_diagonal_rays) {
-    auto nw_attacked = ray_nw_table[from.index()];
-    blockers = (nw_attacked & occupied) | 0x8000000000000000ull;
-    blocking_square = blockers.find_first();
-    nw_attacked ^= ray_nw_table[blocking_square.index()];
-
-    auto ne_attacked = ray_ne_table[from.index()];
-    blockers = (ne_attacked & occupied) | 0x8000000000000000ull;
-    blocking_square = blockers.find_first();
-    ne_attacked ^= ray_ne_table[blocking_square.index()];
-
-    auto se_attacked = ray_se_table[from.index()];
-    blockers = (se_attacked & occupied) | 1ull;
-    blocking_square = blockers.find_last();
-    se_attacked ^= ray_se_table[blocking_square.index()];
-
-    auto sw_attacked = ray_sw_table[from.index()];
-    blockers = (sw_attacked & occupied) | 1ull;
-    blocking_square = blockers.find_last();
-    sw_attacked ^= ray_sw_table[blocking_square.index()];
-
-    attacked |= nw_attacked | ne_attacked | se_attacked | sw_attacked;
-  }
-
-  if (generate_orthogonal_rays) {
-    auto n_attacked = ray_n_table[from.index()];
-    blockers = (n_attacked & occupied) | 0x8000000000000000ull;
-    blocking_square = blockers.find_first();
-    n_attacked ^= ray_n_table[blocking_square.index()];
-
-    auto e_attacked = ray_e_table[from.index()];
-    blockers = (e_attacked & occupied) | 0x8000000000000000ull;
-    blocking_square = blockers.find_first();
-    e_attacked ^= ray_e_table[blocking_square.index()];
-
-    auto s_attacked = ray_s_table[from.index()];
-    blockers = (s_attacked & occupied) | 1ull;
-    blocking_square = blockers.find_last();
-    s_attacked ^= ray_s_table[blocking_square.index()];
-
-    auto w_attacked = ray_w_table[from.index()];
-    blockers = (w_attacked & occupied) | 1ull;
-    blocking_square = blockers.find_last();
-    w_attacked ^= ray_w_table[blocking_square.index()];
-
-    attacked |= n_attacked | e_attacked | s_attacked | w_attacked;
-  }
-
-  return attacked;
-}
-
-Bitboard pawn_move_board(int side, Square square) {
-  return pawn_move_tables[side][square.index()];
-}
-
-Bitboard pawn_double_move_board(int side, Square square) {
-  return pawn_double_move_tables[side][square.index()];
-}
-
-Bitboard pawn_attack_board(int side, Square square) {
-  return pawn_capture_tables[side][square.index()];
-}
-
-Bitboard pawn_attack_board(int side, Bitboard squares) {
-  Bitboard attacked = 0;
-
-  BitboardIterator square_iter(squares);
-  while (square_iter.has_data()) {
-    auto square = square_iter.next();
-    attacked.set(pawn_attack_board(side, square));
-  }
-
-  return attacked;
-}
-
-Bitboard knight_attack_board(Square square) {
-  return knight_attack_table[square.index()];
-}
-
-Bitboard knight_attack_board(Bitboard squares) {
-  Bitboard attacked = 0;
-
-  BitboardIterator square_iter(squares);
-  while (square_iter.has_data()) {
-    auto square = square_iter.next();
-    attacked.set(knight_attack_board(square));
-  }
-
-  return attacked;
-}
-
-Bitboard bishop_attack_board(Bitboard occupied, Square square) {
-  return ray_attack_table<true, false>(occupied, square);
-}
-
-Bitboard bishop_attack_board(Bitboard occupied, Bitboard squares) {
-  Bitboard attacked = 0;
-
-  BitboardIterator square_iter(squares);
-  while (square_iter.has_data()) {
-    auto square = square_iter.next();
-    attacked.set(bishop_attack_board(occupied, square));
-  }
-
-  return attacked;
-}
-
-Bitboard rook_attack_board(Bitboard occupied, Square square) {
-  return ray_attack_table<false, true>(occupied, square);
-}
-
-Bitboard rook_attack_board(Bitboard occupied, Bitboard squares) {
-  Bitboard attacked = 0;
-
-  BitboardIterator square_iter(squares);
-  while (square_iter.has_data()) {
-    auto square = square_iter.next();
-    attacked.set(rook_attack_board(occupied, square));
-  }
-
-  return attacked;
-}
-
-Bitboard queen_attack_board(Bitboard occupied, Square square) {
-  return ray_attack_table<true, true>(occupied, square);
-}
-
-Bitboard queen_attack_board(Bitboard occupied, Bitboard squares) {
-  Bitboard attacked = 0;
-
-  BitboardIterator square_iter(squares);
-  while (square_iter.has_data()) {
-    auto square = square_iter.next();
-    attacked.set(queen_attack_board(occupied, square));
-  }
-
-  return attacked;
-}
-
-Bitboard king_attack_board(Square square) {
-  return king_attack_table[square.index()];
-}
-
-Bitboard king_attack_board(Bitboard squares) {
-  Bitboard attacked = 0;
-
-  BitboardIterator square_iter(squares);
-  while (square_iter.has_data()) {
-    auto square = square_iter.next();
-    attacked.set(king_attack_board(square));
-  }
-
-  return attacked;
-}
-} // namespace chess
\ No newline at end of file
+#include <array>
+#include <tuple>
+
+#include <libchess/bitboard_iterator.h>
+#include <libchess/board.h>
+#include <libchess/piece.h>
+
+namespace chess {
+
+constexpr std::array<std::array<Bitboard, 64>, kNumSides>
+compute_pawn_move_tables() {
+  std::array<std::array<Bitboard, 64>, kNumSides> move_tables{};
+  for (auto side = 0; side < kNumSides; side++) {
+    const auto direction = side == 0 ? 1 : -1;
+    std::array<Bitboard, 64> moves{};
+    for (Square square = 0; square < 64; square++) {
+      auto file = square.file();
+      auto rank = square.rank();
+      Bitboard board = 0;
+
+      auto rank_offset = rank + direction;
+      if (rank_offset < 0 || rank_offset > 7)
+        continue;
+
+      board.set(Square(file, rank_offset));
+      moves[square.index()] = board;
+    }
+
+    move_tables[side] = moves;
+  }
+
+  return move_tables;
+}
+
+constexpr std::array<std::array<Bitboard, 64>, kNumSides>
+compute_pawn_double_move_tables() {
+  std::array<std::array<Bitboard, 64>, kNumSides> move_tables{};
+  for (auto side = 0; side < kNumSides; side++) {
+    const auto direction = side == 0 ? 2 : -2;
+    const auto double_move_rank = side == chess::kSideWhite ? 1 : 6;
+    std::array<Bitboard, 64> moves{};
+    for (Square square = 0; square < 64; square++) {
+      Bitboard board = 0;
+
+      if (square.rank() == double_move_rank) {
+        board.set(Square(square.file(), double_move_rank + direction));
+      }
+
+      moves[square.index()] = board;
+    }
+
+    move_tables[side] = moves;
+  }
+
+  return move_tables;
+}
+
+constexpr std::array<std::array<Bitboard, 64>, kNumSides>
+compute_pawn_capture_tables() {
+  constexpr int offsets[] = {-1, 1};
+
+  std::array<std::array<Bitboard, 64>, kNumSides> capture_tables{};
+  for (auto side = 0; side < kNumSides; side++) {
+    auto direction = side == 0 ? 1 : -1;
+    std::array<Bitboard, 64> moves{};
+    for (Square square = 0; square < 64; square++) {
+      auto file = square.file();
+      auto rank = square.rank();
+      Bitboard board = 0;
+
+      for (auto offset : offsets) {
+        auto file_offset = file + offset;
+        auto rank_offset = rank + direction;
+        if (file_offset < 0 || file_offset > 7)
+          continue;
+        if (rank_offset < 0 || rank_offset > 7)
+          continue;
+        board.set(Square(file_offset, rank_offset));
+      }
+
+      moves[square.index()] = board;
+    }
+
+    capture_tables[side] = moves;
+  }
+
+  return capture_tables;
+}
+
+constexpr std::array<Bitboard, 64> compute_knight_table() {
+  constexpr std::tuple<int, int> offsets[] = {
+      {-2, 1}, {-1, 2}, {1, 2}, {2, 1}, {2, -1}, {1, -2}, {-1, -2}, {-2, -1}};
+  std::array<Bitboard, 64> moves = {0};
+  for (Square square = 0; square < 64; square++) {
+    auto file = square.file();
+    auto rank = square.rank();
+    Bitboard board = 0;
+
+    for (auto offset : offsets) {
+      auto file_offset = file + std::get<0>(offset);
+      auto rank_offset = rank + std::get<1>(offset);
+      if (file_offset < 0 || file_offset > 7)
+        continue;
+      if (rank_offset < 0 || rank_offset > 7)
+        continue;
+      board.set(Square(file_offset, rank_offset));
+    }
+
+    moves[square.index()] = board;
+  }
+
+  return moves;
+}
+
+constexpr std::array<Bitboard, 64> compute_king_table() {
+  constexpr std::tuple<int, int> offsets[] = {
+      {-1, -1}, {-1, 0}, {-1, 1}, {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1}};
+  std::array<Bitboard, 64> moves = {0};
+  for (Square square = 0; square < 64; square++) {
+    auto file = square.file();
+    auto rank = square.rank();
+    Bitboard board = 0;
+
+    for (auto offset : offsets) {
+      auto file_offset = file + std::get<0>(offset);
+      auto rank_offset = rank + std::get<1>(offset);
+      if (file_offset < 0 || file_offset > 7)
+        continue;
+      if (rank_offset < 0 || rank_offset > 7)
+        continue;
+      board.set(Square(file_offset, rank_offset));
+    }
+
+    moves[square.index()] = board;
+  }
+
+  return moves;
+}
+
+template <int file_offset, int rank_offset>
+constexpr std::array<Bitboard, 64> compute_ray_table() {
+  std::array<Bitboard, 64> moves = {0};
+  for (Square square = 0; square < 64; square++) {
+    Bitboard board = 0;
+    auto file = square.file() + file_offset;
+    auto rank = square.rank() + rank_offset;
+
+    while (true) {
+      if (file < 0 || file > 7)
+        break;
+      if (rank < 0 || rank > 7)
+        break;
+
+      board.set(Square(file, rank));
+
+      file += file_offset;
+      rank += rank_offset;
+    }
+
+    moves[square.index()] = board;
+  }
+
+  return moves;
+}
+
+// Attack look up tables, computed at compile time.
+constexpr std::array<std::array<Bitboard, 64>, kNumSides> pawn_move_tables =
+    compute_pawn_move_tables();
+constexpr std::array<std::array<Bitboard, 64>, kNumSides>
+    pawn_double_move_tables = compute_pawn_double_move_tables();
+constexpr std::array<std::array<Bitboard, 64>, kNumSides> pawn_capture_tables =
+    compute_pawn_capture_tables();
+constexpr std::array<Bitboard, 64> knight_attack_table = compute_knight_table();
+constexpr std::array<Bitboard, 64> king_attack_table = compute_king_table();
+
+// Lookup tables for bishop/rook/queen directional attacks
+constexpr std::array<Bitboard, 64> ray_n_table = compute_ray_table<0, 1>();
+constexpr std::array<Bitboard, 64> ray_e_table = compute_ray_table<1, 0>();
+constexpr std::array<Bitboard, 64> ray_s_table = compute_ray_table<0, -1>();
+constexpr std::array<Bitboard, 64> ray_w_table = compute_ray_table<-1, 0>();
+
+constexpr std::array<Bitboard, 64> ray_nw_table = compute_ray_table<-1, 1>();
+constexpr std::array<Bitboard, 64> ray_ne_table = compute_ray_table<1, 1>();
+constexpr std::array<Bitboard, 64> ray_se_table = compute_ray_table<1, -1>();
+constexpr std::array<Bitboard, 64> ray_sw_table = compute_ray_table<-1, -1>();
+
+// Ray tables paired with the ray running the opposite way.
+constexpr const std::array<Bitboard, 64> *ray_tables[4][2] = {
+    {&ray_n_table, &ray_s_table},
+    {&ray_e_table, &ray_w_table},
+    {&ray_ne_table, &ray_sw_table},
+    {&ray_nw_table, &ray_se_table}};
+
+constexpr std::array<std::array<Bitboard, 64>, 64> compute_between_table() {
+  std::array<std::array<Bitboard, 64>, 64> between{};
+  for (Square from = 0; from < 64; from++) {
+    for (Square to = 0; to < 64; to++) {
+      for (const auto &rays : ray_tables) {
+        for (const auto *ray : rays) {
+          // The ray from |to| continues past it in the same direction.
+          if ((*ray)[from.index()].occupied(to)) {
+            between[from.index()][to.index()] =
+                (*ray)[from.index()] & ~(*ray)[to.index()] &
+                ~Bitboard(1ull << to.index());
+          }
+        }
+      }
+    }
+  }
+
+  return between;
+}
+
+constexpr std::array<std::array<Bitboard, 64>, 64> compute_line_table() {
+  std::array<std::array<Bitboard, 64>, 64> lines{};
+  for (Square from = 0; from < 64; from++) {
+    for (Square to = 0; to < 64; to++) {
+      for (const auto &rays : ray_tables) {
+        const auto line = (*rays[0])[from.index()] |
+                          (*rays[1])[from.index()] |
+                          Bitboard(1ull << from.index());
+        if (from != to && line.occupied(to)) {
+          lines[from.index()][to.index()] = line;
+        }
+      }
+    }
+  }
+
+  return lines;
+}
+
+// Squares between and through pairs of aligned squares. Used to find pins and
+// the squares that block a check.
+constexpr std::array<std::array<Bitboard, 64>, 64> between_table =
+    compute_between_table();
+constexpr std::array<std::array<Bitboard, 64>, 64> line_table =
+    compute_line_table();
+
+template <bool generate_diagonal_rays, bool generate_orthogonal_rays>
+inline Bitboard ray_attack_table(const Bitboard occupied, const Square from) {
+  Bitboard attacked = 0;
+  Bitboard blockers = 0;
+  Square blocking_square;
+
+  if (generate_diagonal_rays) {
+    auto nw_attacked = ray_nw_table[from.index()];
+    blockers = (nw_attacked & occupied) | 0x8000000000000000ull;
+    blocking_square = blockers.find_first();
+    nw_attacked ^= ray_nw_table[blocking_square.index()];
+
+    auto ne_attacked = ray_ne_table[from.index()];
+    blockers = (ne_attacked & occupied) | 0x8000000000000000ull;
+    blocking_square = blockers.find_first();
+    ne_attacked ^= ray_ne_table[blocking_square.index()];
+
+    auto se_attacked = ray_se_table[from.index()];
+    blockers = (se_attacked & occupied) | 1ull;
+    blocking_square = blockers.find_last();
+    se_attacked ^= ray_se_table[blocking_square.index()];
+
+    auto sw_attacked = ray_sw_table[from.index()];
+    blockers = (sw_attacked & occupied) | 1ull;
+    blocking_square = blockers.find_last();
+    sw_attacked ^= ray_sw_table[blocking_square.index()];
+
+    attacked |= nw_attacked | ne_attacked | se_attacked | sw_attacked;
+  }
+
+  if (generate_orthogonal_rays) {
+    auto n_attacked = ray_n_table[from.index()];
+    blockers = (n_attacked & occupied) | 0x8000000000000000ull;
+    blocking_square = blockers.find_first();
+    n_attacked ^= ray_n_table[blocking_square.index()];
+
+    auto e_attacked = ray_e_table[from.index()];
+    blockers = (e_attacked & occupied) | 0x8000000000000000ull;
+    blocking_square = blockers.find_first();
+    e_attacked ^= ray_e_table[blocking_square.index()];
+
+    auto s_attacked = ray_s_table[from.index()];
+    blockers = (s_attacked & occupied) | 1ull;
+    blocking_square = blockers.find_last();
+    s_attacked ^= ray_s_table[blocking_square.index()];
+
+    auto w_attacked = ray_w_table[from.index()];
+    blockers = (w_attacked & occupied) | 1ull;
+    blocking_square = blockers.find_last();
+    w_attacked ^= ray_w_table[blocking_square.index()];
+
+    attacked |= n_attacked | e_attacked | s_attacked | w_attacked;
+  }
+
+  return attacked;
+}
+
+#if !CHESSLIB_PEXT
+// Magic multipliers for every square, found offline by a search over sparse
+// random numbers. The slider tables below only have to be filled in at
+// startup.
+constexpr uint64_t bishop_magics[64] = {
+    0x40106000a1160020ull, 0x0020010250810120ull, 0x2010010220280081ull,
+    0x002806004050c040ull, 0x0002021018000000ull, 0x2001112010000400ull,
+    0x0881010120218080ull, 0x1030820110010500ull, 0x0000120222042400ull,
+    0x2000020404040044ull, 0x8000480094208000ull, 0x0003422a02000001ull,
+    0x000a220210100040ull, 0x8004820202226000ull, 0x0018234854100800ull,
+    0x0100004042101040ull, 0x0004001004082820ull, 0x0010000810010048ull,
+    0x1014004208081300ull, 0x2080818802044202ull, 0x0040880c00a00100ull,
+    0x0080400200522010ull, 0x0001000188180b04ull, 0x0080249202020204ull,
+    0x1004400004100410ull, 0x00013100a0022206ull, 0x2148500001040080ull,
+    0x4241080011004300ull, 0x4020848004002000ull, 0x10101380d1004100ull,
+    0x0008004422020284ull, 0x01010a1041008080ull, 0x0808080400082121ull,
+    0x0808080400082121ull, 0x0091128200100c00ull, 0x0202200802010104ull,
+    0x8c0a020200440085ull, 0x01a0008080b10040ull, 0x0889520080122800ull,
+    0x100902022202010aull, 0x04081a0816002000ull, 0x0000681208005000ull,
+    0x8170840041008802ull, 0x0a00004200810805ull, 0x0830404408210100ull,
+    0x2602208106006102ull, 0x1048300680802628ull, 0x2602208106006102ull,
+    0x0602010120110040ull, 0x0941010801043000ull, 0x000040440a210428ull,
+    0x0008240020880021ull, 0x0400002012048200ull, 0x00ac102001210220ull,
+    0x0220021002009900ull, 0x84440c080a013080ull, 0x0001008044200440ull,
+    0x0004c04410841000ull, 0x2000500104011130ull, 0x1a0c010011c20229ull,
+    0x0044800112202200ull, 0x0434804908100424ull, 0x0300404822c08200ull,
+    0x48081010008a2a80ull};
+constexpr uint64_t rook_magics[64] = {
+    0x0a80004000801220ull, 0x8040004010002008ull, 0x2080200010008008ull,
+    0x1100100008210004ull, 0xc200209084020008ull, 0x2100010004000208ull,
+    0x0400081000822421ull, 0x0200010422048844ull, 0x0800800080400024ull,
+    0x0001402000401000ull, 0x3000801000802001ull, 0x4400800800100083ull,
+    0x0904802402480080ull, 0x4040800400020080ull, 0x0018808042000100ull,
+    0x4040800080004100ull, 0x0040048001458024ull, 0x00a0004000205000ull,
+    0x3100808010002000ull, 0x4825010010000820ull, 0x5004808008000401ull,
+    0x2024818004000a00ull, 0x0005808002000100ull, 0x2100060004806104ull,
+    0x0080400880008421ull, 0x4062220600410280ull, 0x010a004a00108022ull,
+    0x0000100080080080ull, 0x0021000500080010ull, 0x0044000202001008ull,
+    0x0000100400080102ull, 0xc020128200040545ull, 0x0080002000400040ull,
+    0x0000804000802004ull, 0x0000120022004080ull, 0x010a386103001001ull,
+    0x9010080080800400ull, 0x8440020080800400ull, 0x0004228824001001ull,
+    0x000000490a000084ull, 0x0080002000504000ull, 0x200020005000c000ull,
+    0x0012088020420010ull, 0x0010010080080800ull, 0x0085001008010004ull,
+    0x0002000204008080ull, 0x0040413002040008ull, 0x0000304081020004ull,
+    0x0080204000800080ull, 0x3008804000290100ull, 0x1010100080200080ull,
+    0x2008100208028080ull, 0x5000850800910100ull, 0x8402019004680200ull,
+    0x0120911028020400ull, 0x0000008044010200ull, 0x0020850200244012ull,
+    0x0020850200244012ull, 0x0000102001040841ull, 0x140900040a100021ull,
+    0x000200282410a102ull, 0x000200282410a102ull, 0x000200282410a102ull,
+    0x4048240043802106ull};
+#endif
+
+template <bool diagonal, size_t table_size>
+void fill_slider_table(SliderTable<table_size> &table) {
+  constexpr uint64_t rank_edges = 0xff000000000000ffull;
+  constexpr uint64_t file_edges = 0x8181818181818181ull;
+
+  uint32_t offset = 0;
+
+  for (Square square = 0; square < 64; square++) {
+    // Pieces on the edge of the board never block a slider, so they're left
+    // out of the mask.
+    const uint64_t edges =
+        (rank_edges & ~(0xffull << (square.rank() * 8))) |
+        (file_edges & ~(0x0101010101010101ull << square.file()));
+
+    auto &magic = table.magics[square.index()];
+    magic.mask =
+        ray_attack_table<diagonal, !diagonal>(0, square).data() & ~edges;
+    magic.shift = 64 - platform::popcount(magic.mask);
+    magic.offset = offset;
+
+#if CHESSLIB_PEXT
+    magic.magic = 0;
+#else
+    magic.magic = diagonal ? bishop_magics[square.index()]
+                           : rook_magics[square.index()];
+#endif
+
+    // Fill in every subset of the mask (Carry-Rippler) with its attack set.
+    int size = 0;
+    uint64_t subset = 0;
+    do {
+      const auto attacks =
+          ray_attack_table<diagonal, !diagonal>(subset, square);
+      auto &entry = table.attacks[magic.index(subset)];
+      // Every slider attacks at least one square, so an empty entry is
+      // unused. Subsets sharing an index must share their attack set.
+      assert(entry == 0 || entry == attacks);
+      entry = attacks;
+      size++;
+      subset = (subset - magic.mask) & magic.mask;
+    } while (subset);
+
+    offset += size;
+  }
+
+  assert(offset == table_size);
+}
+
+// Magic bitboard lookup tables for bishop/rook/queen attacks. Zero until
+// SliderTableInit fills them in from the constant ray tables. Every member has
+// a constant initializer, so they're zeroed at compile time rather than after
+// the SliderTableInit above them in this file has already run.
+SliderTable<bishop_table_size> bishop_table;
+SliderTable<rook_table_size> rook_table;
+
+SliderTableInit::SliderTableInit() {
+  // Only the first instance to be constructed does any work. Initializing a
+  // local static is thread safe, though in practice this all runs before
+  // main().
+  static const bool filled = [] {
+    fill_slider_table<true>(bishop_table);
+    fill_slider_table<false>(rook_table);
+    return true;
+  }();
+  static_cast<void>(filled);
+}
+
+Bitboard pawn_attack_board(int side, Bitboard squares) {
+  Bitboard attacked = 0;
+
+  BitboardIterator square_iter(squares);
+  while (square_iter.has_data()) {
+    auto square = square_iter.next();
+    attacked.set(pawn_attack_board(side, square));
+  }
+
+  return attacked;
+}
+
+Bitboard knight_attack_board(Bitboard squares) {
+  Bitboard attacked = 0;
+
+  BitboardIterator square_iter(squares);
+  while (square_iter.has_data()) {
+    auto square = square_iter.next();
+    attacked.set(knight_attack_board(square));
+  }
+
+  return attacked;
+}
+
+Bitboard bishop_attack_board(Bitboard occupied, Bitboard squares) {
+  Bitboard attacked = 0;
+
+  BitboardIterator square_iter(squares);
+  while (square_iter.has_data()) {
+    auto square = square_iter.next();
+    attacked.set(bishop_attack_board(occupied, square));
+  }
+
+  return attacked;
+}
+
+Bitboard rook_attack_board(Bitboard occupied, Bitboard squares) {
+  Bitboard attacked = 0;
+
+  BitboardIterator square_iter(squares);
+  while (square_iter.has_data()) {
+    auto square = square_iter.next();
+    attacked.set(rook_attack_board(occupied, square));
+  }
+
+  return attacked;
+}
+
+Bitboard queen_attack_board(Bitboard occupied, Bitboard squares) {
+  Bitboard attacked = 0;
+
+  BitboardIterator square_iter(squares);
+  while (square_iter.has_data()) {
+    auto square = square_iter.next();
+    attacked.set(queen_attack_board(occupied, square));
+  }
+
+  return attacked;
+}
+
+Bitboard bishop_ray_attack_board(Bitboard occupied, Square square) {
+  return ray_attack_table<true, false>(occupied, square);
+}
+
+Bitboard rook_ray_attack_board(Bitboard occupied, Square square) {
+  return ray_attack_table<false, true>(occupied, square);
+}
+
+Bitboard queen_ray_attack_board(Bitboard occupied, Square square) {
+  return ray_attack_table<true, true>(occupied, square);
+}
+
+Bitboard king_attack_board(Bitboard squares) {
+  Bitboard attacked = 0;
+
+  BitboardIterator square_iter(squares);
+  while (square_iter.has_data()) {
+    auto square = square_iter.next();
+    attacked.set(king_attack_board(square));
+  }
+
+  return attacked;
+}
+} // namespace chess
@@ -1,56 +1,188 @@
-#include <bitset>
-#include <iostream>
-
-#include <libchess/board.h>
-
-int main() {
-  bool failed = false;
-  {
-    auto board = chess::Board::from_fen("");
-    if (board != chess::null_board) {
-      std::cerr << "Empty FEN didn't return null board" << std::endl;
-      failed = true;
-    }
-  }
-
-  {
-    auto board = chess::Board::from_fen("8/8/8/8/8/8/8/P7 b KQq h8 0 1");
-    if (board.pawns(0) != 1) {
-      std::cerr << "Single pawn test failed" << std::endl;
-      failed = true;
-    }
-
-    if (board.turn() != 1) {
-      std::cerr << "FEN turn test failed" << std::endl;
-      failed = true;
-    }
-
-    if (board.castling(chess::kCastleBlackKingSide) != 0) {
-      std::cerr << "Castle rights test failed" << std::endl;
-      failed = true;
-    }
-
-    if (board.ep_square() != 63) {
-      std::cerr << "En passant square test failed" << std::endl;
-      failed = true;
-    }
-  }
-
-  {
-    auto board =
-        chess::Board::from_fen("8/pppppppp/8/8/8/8/PPPPPPPP/8 w - - 0 1");
-    auto white_pawns = board.pawns(chess::kSideWhite).data();
-    auto black_pawns = board.pawns(chess::kSideBlack).data();
-    if (white_pawns != 0x000000000000ff00 ||
-        black_pawns != 0x00ff000000000000) {
-      std::cerr << "Pawn test failed" << std::endl;
-      std::cerr << "  White pawns: " << std::hex << white_pawns << " - "
-                << std::bitset<64>(white_pawns) << std::endl;
-      std::cerr << "  Black pawns: " << std::hex << black_pawns << " - "
-                << std::bitset<64>(black_pawns) << std::endl;
-      failed = true;
-    }
-  }
-
-  return failed;
-}
\ No newline at end of file
+#include <bitset>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <libchess/board.h>
+
+int main() {
+  bool failed = false;
+  {
+    auto board = chess::Board::from_fen("");
+    if (board != chess::null_board) {
+      std::cerr << "Empty FEN didn't return null board" << std::endl;
+      failed = true;
+    }
+  }
+
+  {
+    auto board = chess::Board::from_fen("8/8/8/8/7P/8/8/P7 b KQq h3 0 1");
+    if (board.pawns(0) != (1ull | 1ull << 31)) {
+      std::cerr << "Single pawn test failed" << std::endl;
+      failed = true;
+    }
+
+    if (board.turn() != 1) {
+      std::cerr << "FEN turn test failed" << std::endl;
+      failed = true;
+    }
+
+    if (board.castling(chess::kCastleBlackKingSide) != 0) {
+      std::cerr << "Castle rights test failed" << std::endl;
+      failed = true;
+    }
+
+    if (board.ep_square() != 23) {
+      std::cerr << "En passant square test failed" << std::endl;
+      failed = true;
+    }
+  }
+
+  {
+    auto board =
+        chess::Board::from_fen("8/pppppppp/8/8/8/8/PPPPPPPP/8 w - - 0 1");
+    auto white_pawns = board.pawns(chess::kSideWhite).data();
+    auto black_pawns = board.pawns(chess::kSideBlack).data();
+    if (white_pawns != 0x000000000000ff00 ||
+        black_pawns != 0x00ff000000000000) {
+      std::cerr << "Pawn test failed" << std::endl;
+      std::cerr << "  White pawns: " << std::hex << white_pawns << " - "
+                << std::bitset<64>(white_pawns) << std::endl;
+      std::cerr << "  Black pawns: " << std::hex << black_pawns << " - "
+                << std::bitset<64>(black_pawns) << std::endl;
+      failed = true;
+    }
+  }
+
+  {
+    chess::Bitboard pieces[chess::kNumSides][chess::kNumPieces] = {};
+    pieces[chess::kSideWhite][chess::kPieceKing] = 1ull << 4;
+    pieces[chess::kSideWhite][chess::kPieceRook] = 1ull << 7;
+    pieces[chess::kSideBlack][chess::kPieceKing] = 1ull << 60;
+    const chess::Board board(pieces, 1 << chess::kCastleWhiteKingSide,
+                             chess::kSideBlack, chess::null_square, 3, 20);
+    if (board != chess::Board::from_fen("4k3/8/8/8/8/8/8/4K2R b K - 3 20")) {
+      std::cerr << "Bitboard constructor test failed" << std::endl;
+      failed = true;
+    }
+
+    if (board.piece_type_at(chess::kSideWhite, 7) != chess::kPieceRook ||
+        board.piece_type_at(chess::kSideBlack, 7) != -1 ||
+        board.occupied().count() != 3) {
+      std::cerr << "Bitboard constructor piece test failed" << std::endl;
+      failed = true;
+    }
+  }
+
+  {
+    const std::pair<const char *, chess::FenError> cases[] = {
+        {"", chess::kFenEmpty},
+        {"   \r", chess::kFenEmpty},
+        {"8/8/8/8/8/8/8 w - - 0 1", chess::kFenBadPlacement},
+        {"8/8/8/8/8/8/8/9 w - - 0 1", chess::kFenBadPlacement},
+        {"8/8/8/8/8/8/8/P8 w - - 0 1", chess::kFenBadPlacement},
+        {"8/8/8/8/8/8/8/X7 w - - 0 1", chess::kFenBadPlacement},
+        {"Q6Q/3Q4/1Q4Q1/4Q3/2Q4Q/Q4Q2/3Q4/k1Q2K1Q w - - 0 1",
+         chess::kFenBadPlacement},
+        {"4k3/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQ - 0 1",
+         chess::kFenOk},
+        {"4k3/8/8/8/8/8/PPPPPPPP/RNBQKBNQ w Q - 0 1", chess::kFenBadPlacement},
+        {"4k3/8/8/8/8/8/8/4KK2 w - - 0 1", chess::kFenBadPlacement},
+        {"8/8/8/8/8/8/8/8/8 w - - 0 1", chess::kFenBadPlacement},
+        {"8/8/8/8/8/8/8/8 x - - 0 1", chess::kFenBadSide},
+        {"8/8/8/8/8/8/8/8 w KX - 0 1", chess::kFenBadCastling},
+        {"8/8/8/8/8/8/8/8 w - e9 0 1", chess::kFenBadEnPassant},
+        {"4k3/8/8/8/8/3P4/8/4K3 w - e4 0 1", chess::kFenBadEnPassant},
+        {"4k3/8/8/3P4/8/8/8/4K3 w - e6 0 1", chess::kFenBadEnPassant},
+        {"4k3/8/4p3/3P4/8/8/8/4K3 w - e6 0 1", chess::kFenBadEnPassant},
+        {"4k3/4n3/8/3Pp3/8/8/8/4K3 w - e6 0 1", chess::kFenBadEnPassant},
+        {"4k3/8/8/3Pp3/8/8/8/4K3 w - e6 0 1", chess::kFenOk},
+        {"8/8/8/8/8/8/8/8 b - e6 0 1", chess::kFenBadEnPassant},
+        {"8/8/8/8/8/8/8/8 w -", chess::kFenBadEnPassant},
+        {"8/8/8/8/8/8/8/8 w - - 0", chess::kFenBadClock},
+        {"8/8/8/8/8/8/8/8 w - - 0 x", chess::kFenBadClock},
+        {"8/8/8/8/8/8/8/8 w - - 99999 1", chess::kFenBadClock},
+        {"8/8/8/8/8/8/8/8 w - - 0 1\r", chess::kFenOk},
+    };
+
+    for (const auto &test_case : cases) {
+      chess::Board board;
+      if (chess::Board::parse_fen(test_case.first, &board) !=
+          test_case.second) {
+        std::cerr << "FEN error test failed: " << test_case.first
+                  << std::endl;
+        failed = true;
+      }
+    }
+  }
+
+  {
+    // EPD lines have no clocks, and their operations are left to the caller.
+    chess::Board board;
+    std::string_view rest;
+    const auto error = chess::Board::parse_fen(
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - ;D1 20 ;D2 400",
+        &board, &rest);
+    if (error != chess::kFenOk || rest != ";D1 20 ;D2 400" ||
+        board != chess::Board::from_fen(
+                     "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 "
+                     "1")) {
+      std::cerr << "EPD test failed" << std::endl;
+      failed = true;
+    }
+  }
+
+  {
+    const char buffer[] =
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1\r\n"
+        "\r\n"
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1\n"
+        "4k3/8/8/8/8/8/8/4K2R b K - 3 20";
+    chess::Board boards[4];
+    chess::FenError error;
+    const auto count = chess::Board::parse_fens(buffer, boards, 4, &error);
+    if (count != 3 || error != chess::kFenOk ||
+        boards[1].fen() != "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1" ||
+        boards[2].fen() != "4k3/8/8/8/8/8/8/4K2R b K - 3 20") {
+      std::cerr << "Bulk FEN test failed" << std::endl;
+      failed = true;
+    }
+
+    if (chess::Board::parse_fens(buffer, boards, 1, &error) != 1 ||
+        chess::Board::parse_fens("8/8 w - - 0 1\n", boards, 4, &error) != 0 ||
+        error != chess::kFenBadPlacement) {
+      std::cerr << "Bulk FEN limit test failed" << std::endl;
+      failed = true;
+    }
+  }
+
+  {
+    // Every field at its widest fits in max_fen_length. A full board can't
+    // be parsed, so that one is built from bitboards.
+    chess::Bitboard pieces[chess::kNumSides][chess::kNumPieces] = {};
+    pieces[chess::kSideWhite][chess::kPiecePawn] = 0x00000000ffffffffull;
+    pieces[chess::kSideBlack][chess::kPiecePawn] = 0xffffffff00000000ull;
+    const std::pair<chess::Board, const char *> cases[] = {
+        {chess::Board::from_fen(
+             "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"),
+         "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"},
+        {chess::Board(pieces, 0xf, chess::kSideBlack, chess::Square(4, 2),
+                      65535, 65535),
+         "pppppppp/pppppppp/pppppppp/pppppppp/PPPPPPPP/PPPPPPPP/PPPPPPPP/"
+         "PPPPPPPP b KQkq e3 65535 65535"},
+    };
+    for (const auto &test_case : cases) {
+      const std::string fen = test_case.second;
+      char buffer[chess::max_fen_length + 1];
+      const auto length = test_case.first.write_fen(buffer);
+      if (std::string(buffer) != fen || length != fen.size() ||
+          length > chess::max_fen_length) {
+        std::cerr << "FEN writing test failed: " << buffer << std::endl;
+        failed = true;
+      }
+    }
+  }
+
+  return failed;
+}
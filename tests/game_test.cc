@@ -1,244 +1,556 @@
-#include <iostream>
-
-#include <libchess/game.h>
-#include <libchess/square.h>
-
-constexpr char piece_symbols[] = {'p', 'n', 'b', 'r', 'q', 'k'};
-
-void print_board(chess::Board &board) {
-  for (auto y = 7; y >= 0; y--) {
-    for (auto x = 0; x < 8; x++) {
-      auto square = chess::Square(x, y);
-      if (board.square_occupied(square)) {
-        auto side = board.turn();
-        auto piece_type = board.piece_type_at(side, square);
-        if (piece_type == -1) {
-          side = !side;
-          piece_type = board.piece_type_at(side, square);
-        }
-
-        auto symbol = piece_symbols[piece_type];
-        if (side == chess::kSideWhite) {
-          symbol = toupper(symbol);
-        }
-
-        std::cerr << symbol;
-      } else {
-        std::cerr << ".";
-      }
-    }
-
-    std::cerr << std::endl;
-  }
-}
-
-bool test_fen() {
-  bool failed = false;
-
-  // Test to make sure that the original FEN string is reproduced with no state
-  // change
-  {
-    auto board = chess::Board::from_fen(
-        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
-    auto fen = board.fen();
-    if (fen.compare(
-            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1") != 0) {
-      failed = true;
-    }
-  }
-
-  // Testing for proper game state after 1. a4
-  {
-    chess::Game game;
-    game.make_move(chess::Move(8, 24));
-
-    // Note that this FEN string can vary depending on implementation. Lichess
-    // does not record the uncapturable en passant square.
-    auto fen = game.board().fen();
-    if (fen.compare(
-            "rnbqkbnr/pppppppp/8/8/P7/8/1PPPPPPP/RNBQKBNR b KQkq a3 0 1") !=
-        0) {
-      std::cerr << "Bad fen: " << fen << std::endl;
-      failed = true;
-    }
-  }
-
-  return failed;
-}
-
-bool test_castling_rights() {
-  bool failed = false;
-
-  // Test loss of castling rights after a capture.
-  {
-    chess::Game game("4k3/8/8/8/8/8/6p1/4K2R b KQkq - 0 1");
-    game.make_move(chess::Move(chess::Square(6, 1), chess::Square(7, 0), true));
-
-    if (game.board().castling(chess::kCastleWhiteKingSide)) {
-      failed = true;
-    }
-  }
-
-  // Test loss of castling rights after moving a rook
-  {
-    chess::Game game("4k3/8/8/8/8/8/6p1/4K2R w KQkq - 0 1");
-    game.make_move(chess::Move(chess::Square(7, 0), chess::Square(6, 0)));
-
-    if (game.board().castling(chess::kCastleWhiteKingSide)) {
-      failed = true;
-    }
-  }
-
-  // Test loss of castling rights after moving a king
-  {
-    chess::Game game(
-        "rnbqk2r/pp1p2Np/8/4p3/1bP5/2nBP3/PPQ2PPP/R1B1K2R b KQkq - 0 10");
-    game.make_move(chess::Move(chess::Square(4, 7), chess::Square(4, 6)));
-
-    auto board = game.board();
-    if (board.castling(chess::kCastleBlackKingSide) ||
-        board.castling(chess::kCastleBlackQueenSide)) {
-      failed = true;
-    }
-  }
-
-  return failed;
-}
-
-bool test_castling() {
-  bool failed = false;
-
-  {
-    chess::Game game("r3k2r/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b KQkq - 0 1");
-    game.make_move(chess::Move(chess::Square(4, 7), chess::Square(2, 7)));
-
-    auto board = game.board();
-    if (board.piece_type_at(chess::kSideBlack, chess::Square(2, 7)) !=
-            chess::kPieceKing ||
-        board.piece_type_at(chess::kSideBlack, chess::Square(3, 7)) !=
-            chess::kPieceRook) {
-      failed = true;
-    }
-  }
-
-  {
-    chess::Game game("r3k2r/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b KQkq - 0 1");
-    game.make_move(chess::Move(chess::Square(4, 7), chess::Square(6, 7)));
-
-    auto board = game.board();
-    if (board.piece_type_at(chess::kSideBlack, chess::Square(6, 7)) !=
-            chess::kPieceKing ||
-        board.piece_type_at(chess::kSideBlack, chess::Square(5, 7)) !=
-            chess::kPieceRook) {
-      failed = true;
-    }
-  }
-
-  {
-    chess::Game game("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/R3K2R w KQkq - 0 1");
-    game.make_move(chess::Move(chess::Square(4, 0), chess::Square(6, 0)));
-
-    auto board = game.board();
-    if (board.piece_type_at(chess::kSideWhite, chess::Square(6, 0)) !=
-            chess::kPieceKing ||
-        board.piece_type_at(chess::kSideWhite, chess::Square(5, 0)) !=
-            chess::kPieceRook) {
-      failed = true;
-    }
-  }
-
-  {
-    chess::Game game("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/R3K2R w KQkq - 0 1");
-    game.make_move(chess::Move(chess::Square(4, 0), chess::Square(2, 0)));
-
-    auto board = game.board();
-    if (board.piece_type_at(chess::kSideWhite, chess::Square(2, 0)) !=
-            chess::kPieceKing ||
-        board.piece_type_at(chess::kSideWhite, chess::Square(3, 0)) !=
-            chess::kPieceRook) {
-      failed = true;
-    }
-  }
-
-  return failed;
-}
-
-bool test_promotion() {
-  bool failed = false;
-
-  {
-    chess::Game game("7k/P7/8/8/8/8/8/7K w - - 0 1");
-    game.make_move(chess::Move(chess::Square(0, 6), chess::Square(0, 7), false,
-                               false, chess::kPromoteQueen));
-
-    auto board = game.board();
-    if (board.piece_type_at(chess::kSideWhite, chess::Square(0, 7)) !=
-        chess::kPieceQueen) {
-      failed = true;
-    }
-  }
-
-  {
-    chess::Game game("1q5k/P7/8/8/8/8/8/7K w - - 0 1");
-    game.make_move(chess::Move(chess::Square(0, 6), chess::Square(1, 7), true,
-                               false, chess::kPromoteRook));
-
-    auto board = game.board();
-    if (board.piece_type_at(chess::kSideWhite, chess::Square(1, 7)) !=
-        chess::kPieceRook) {
-      failed = true;
-    }
-  }
-
-  return failed;
-}
-
-bool test_en_passant_capture() {
-  bool failed = false;
-
-  {
-    chess::Game game(
-        "rnbqkbnr/pppp1ppp/8/3Pp3/8/8/PPP1PPPP/RNBQKBNR w KQkq e6 0 2");
-    game.make_move(
-        chess::Move(chess::Square(3, 4), chess::Square(4, 5), true, true));
-
-    auto board = game.board();
-    if (board.piece_type_at(chess::kSideBlack, chess::Square(4, 4)) ==
-        chess::kPiecePawn) {
-      failed = true;
-    }
-  }
-
-  return failed;
-}
-
-int main() {
-  bool failed = false;
-
-  if (test_fen()) {
-    std::cerr << "FEN test failed" << std::endl;
-    failed = true;
-  }
-
-  if (test_castling_rights()) {
-    std::cerr << "Castling rights test failed" << std::endl;
-    failed = true;
-  }
-
-  if (test_castling()) {
-    std::cerr << "Castling move test failed" << std::endl;
-    failed = true;
-  }
-
-  if (test_promotion()) {
-    std::cerr << "Promotion move test failed" << std::endl;
-    failed = true;
-  }
-
-  if (test_en_passant_capture()) {
-    std::cerr << "En passant capture test failed" << std::endl;
-    failed = true;
-  }
-
-  return failed;
-}
\ No newline at end of file
+#include <iostream>
+
+#include <libchess/game.h>
+#include <libchess/move_generator.h>
+#include <libchess/square.h>
+
+constexpr char piece_symbols[] = {'p', 'n', 'b', 'r', 'q', 'k'};
+
+void print_board(chess::Board &board) {
+  for (auto y = 7; y >= 0; y--) {
+    for (auto x = 0; x < 8; x++) {
+      auto square = chess::Square(x, y);
+      if (board.square_occupied(square)) {
+        auto side = board.turn();
+        auto piece_type = board.piece_type_at(side, square);
+        if (piece_type == -1) {
+          side = !side;
+          piece_type = board.piece_type_at(side, square);
+        }
+
+        auto symbol = piece_symbols[piece_type];
+        if (side == chess::kSideWhite) {
+          symbol = toupper(symbol);
+        }
+
+        std::cerr << symbol;
+      } else {
+        std::cerr << ".";
+      }
+    }
+
+    std::cerr << std::endl;
+  }
+}
+
+bool test_fen() {
+  bool failed = false;
+
+  // Test to make sure that the original FEN string is reproduced with no state
+  // change
+  {
+    auto board = chess::Board::from_fen(
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    auto fen = board.fen();
+    if (fen.compare(
+            "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1") != 0) {
+      failed = true;
+    }
+  }
+
+  // Testing for proper game state after 1. a4
+  {
+    chess::Game game;
+    game.make_move(chess::Move(8, 24, chess::kMoveDoublePush));
+
+    // Note that this FEN string can vary depending on implementation. Like
+    // Lichess, we don't record the uncapturable en passant square.
+    auto fen = game.board().fen();
+    if (fen.compare(
+            "rnbqkbnr/pppppppp/8/8/P7/8/1PPPPPPP/RNBQKBNR b KQkq - 0 1") !=
+        0) {
+      std::cerr << "Bad fen: " << fen << std::endl;
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_castling_rights() {
+  bool failed = false;
+
+  // Test loss of castling rights after a capture.
+  {
+    chess::Game game("4k3/8/8/8/8/8/6p1/4K2R b KQkq - 0 1");
+    game.make_move(chess::Move(chess::Square(6, 1), chess::Square(7, 0),
+                               chess::kPromoteQueen, true));
+
+    if (game.board().castling(chess::kCastleWhiteKingSide)) {
+      failed = true;
+    }
+  }
+
+  // Test loss of castling rights after moving a rook
+  {
+    chess::Game game("4k3/8/8/8/8/8/6p1/4K2R w KQkq - 0 1");
+    game.make_move(chess::Move(chess::Square(7, 0), chess::Square(6, 0)));
+
+    if (game.board().castling(chess::kCastleWhiteKingSide)) {
+      failed = true;
+    }
+  }
+
+  // Test loss of castling rights after moving a king
+  {
+    chess::Game game(
+        "rnbqk2r/pp1p2Np/8/4p3/1bP5/2nBP3/PPQ2PPP/R1B1K2R b KQkq - 0 10");
+    game.make_move(chess::Move(chess::Square(4, 7), chess::Square(4, 6)));
+
+    auto board = game.board();
+    if (board.castling(chess::kCastleBlackKingSide) ||
+        board.castling(chess::kCastleBlackQueenSide)) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_castling() {
+  bool failed = false;
+
+  {
+    chess::Game game("r3k2r/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b KQkq - 0 1");
+    game.make_move(chess::Move(chess::Square(4, 7), chess::Square(2, 7),
+                               chess::kMoveQueenCastle));
+
+    auto board = game.board();
+    if (board.piece_type_at(chess::kSideBlack, chess::Square(2, 7)) !=
+            chess::kPieceKing ||
+        board.piece_type_at(chess::kSideBlack, chess::Square(3, 7)) !=
+            chess::kPieceRook) {
+      failed = true;
+    }
+  }
+
+  {
+    chess::Game game("r3k2r/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b KQkq - 0 1");
+    game.make_move(chess::Move(chess::Square(4, 7), chess::Square(6, 7),
+                               chess::kMoveKingCastle));
+
+    auto board = game.board();
+    if (board.piece_type_at(chess::kSideBlack, chess::Square(6, 7)) !=
+            chess::kPieceKing ||
+        board.piece_type_at(chess::kSideBlack, chess::Square(5, 7)) !=
+            chess::kPieceRook) {
+      failed = true;
+    }
+  }
+
+  {
+    chess::Game game("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/R3K2R w KQkq - 0 1");
+    game.make_move(chess::Move(chess::Square(4, 0), chess::Square(6, 0),
+                               chess::kMoveKingCastle));
+
+    auto board = game.board();
+    if (board.piece_type_at(chess::kSideWhite, chess::Square(6, 0)) !=
+            chess::kPieceKing ||
+        board.piece_type_at(chess::kSideWhite, chess::Square(5, 0)) !=
+            chess::kPieceRook) {
+      failed = true;
+    }
+  }
+
+  {
+    chess::Game game("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/R3K2R w KQkq - 0 1");
+    game.make_move(chess::Move(chess::Square(4, 0), chess::Square(2, 0),
+                               chess::kMoveQueenCastle));
+
+    auto board = game.board();
+    if (board.piece_type_at(chess::kSideWhite, chess::Square(2, 0)) !=
+            chess::kPieceKing ||
+        board.piece_type_at(chess::kSideWhite, chess::Square(3, 0)) !=
+            chess::kPieceRook) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_promotion() {
+  bool failed = false;
+
+  {
+    chess::Game game("7k/P7/8/8/8/8/8/7K w - - 0 1");
+    game.make_move(chess::Move(chess::Square(0, 6), chess::Square(0, 7),
+                               chess::kPromoteQueen, false));
+
+    auto board = game.board();
+    if (board.piece_type_at(chess::kSideWhite, chess::Square(0, 7)) !=
+        chess::kPieceQueen) {
+      failed = true;
+    }
+  }
+
+  {
+    chess::Game game("1q5k/P7/8/8/8/8/8/7K w - - 0 1");
+    game.make_move(chess::Move(chess::Square(0, 6), chess::Square(1, 7),
+                               chess::kPromoteRook, true));
+
+    auto board = game.board();
+    if (board.piece_type_at(chess::kSideWhite, chess::Square(1, 7)) !=
+        chess::kPieceRook) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_en_passant_capture() {
+  bool failed = false;
+
+  {
+    chess::Game game(
+        "rnbqkbnr/pppp1ppp/8/3Pp3/8/8/PPP1PPPP/RNBQKBNR w KQkq e6 0 2");
+    game.make_move(chess::Move(chess::Square(3, 4), chess::Square(4, 5),
+                               chess::kMoveEnPassant));
+
+    auto board = game.board();
+    if (board.piece_type_at(chess::kSideBlack, chess::Square(4, 4)) ==
+        chess::kPiecePawn) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+// Whether the piece mailbox agrees with the piece bitboards on every square.
+bool mailbox_consistent(const chess::Board &board) {
+  for (chess::Square square = 0; square < 64; square++) {
+    int expected = -1;
+    for (auto side = 0; side < chess::kNumSides; side++) {
+      for (auto piece_type = 0; piece_type < chess::kNumPieces; piece_type++) {
+        if (board.piece_board(side, piece_type).occupied(square)) {
+          expected = piece_type;
+        }
+      }
+    }
+
+    if (board.piece_type_at(square) != expected) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Positions for make and unmake tests. Castling, en passant and capturing
+// promotions are all reachable within two plies.
+const std::string move_test_fens[] = {
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3",
+};
+
+// Plays every legal move sequence |depth| plies deep on |game|, calling
+// |visit| with the game after each move. Every unmake must give back the
+// board, FEN and mailbox from before the move. Returns true if that or any
+// visit failed.
+template <typename Visit>
+bool walk_moves(chess::Game &game, int depth, Visit visit) {
+  bool failed = false;
+
+  chess::MoveGenerator generator;
+  const auto before = game.board();
+  for (const auto move : generator.generate_legal_moves(before)) {
+    game.make_move(move);
+    if (visit(game)) {
+      failed = true;
+    }
+    if (depth > 1 && walk_moves(game, depth - 1, visit)) {
+      failed = true;
+    }
+
+    game.unmake_move();
+    if (game.board() != before || game.board().fen() != before.fen() ||
+        !mailbox_consistent(game.board())) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_piece_mailbox() {
+  bool failed = false;
+
+  for (const auto &fen : move_test_fens) {
+    chess::Game game(fen);
+    if (!mailbox_consistent(game.board()) ||
+        walk_moves(game, 2, [](const chess::Game &game) {
+          return !mailbox_consistent(game.board());
+        })) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_zobrist_key() {
+  bool failed = false;
+
+  // The incremental key matches a fresh board parsed from the same position.
+  {
+    chess::Game game(
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    chess::MoveGenerator generator;
+    const auto moves = generator.generate_legal_moves(game.board());
+    for (auto i = 0; i < moves.size(); i++) {
+      game.make_move(moves.move(i));
+      const auto &board = game.board();
+      if (board.key() != chess::Board::from_fen(board.fen()).key()) {
+        failed = true;
+      }
+      game.unmake_move();
+    }
+  }
+
+  // Transpositions share a key, and side to move, castling rights and the en
+  // passant file all change it.
+  {
+    chess::Game first;
+    first.make_move(chess::Move(chess::Square(6, 0), chess::Square(5, 2)));
+    first.make_move(chess::Move(chess::Square(6, 7), chess::Square(5, 5)));
+    first.make_move(chess::Move(chess::Square(1, 0), chess::Square(2, 2)));
+
+    chess::Game second;
+    second.make_move(chess::Move(chess::Square(1, 0), chess::Square(2, 2)));
+    second.make_move(chess::Move(chess::Square(6, 7), chess::Square(5, 5)));
+    second.make_move(chess::Move(chess::Square(6, 0), chess::Square(5, 2)));
+
+    if (first.board().key() != second.board().key()) {
+      failed = true;
+    }
+
+    const auto start = chess::Board::from_fen(
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+    const std::string changed[] = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b KQkq - 0 1",
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w Qkq - 0 1",
+    };
+    for (const auto &fen : changed) {
+      if (chess::Board::from_fen(fen).key() == start.key()) {
+        failed = true;
+      }
+    }
+
+    if (chess::Board::from_fen(
+            "rnbqkbnr/pppp1ppp/8/3Pp3/8/8/PPP1PPPP/RNBQKBNR w KQkq e6 0 2")
+            .key() ==
+        chess::Board::from_fen(
+            "rnbqkbnr/pppp1ppp/8/3Pp3/8/8/PPP1PPPP/RNBQKBNR w KQkq - 0 2")
+            .key()) {
+      failed = true;
+    }
+  }
+
+  // A null move only flips the side to move and clears en passant.
+  {
+    chess::Game game(
+        "rnbqkbnr/pppp1ppp/8/3Pp3/8/8/PPP1PPPP/RNBQKBNR w KQkq e6 0 2");
+    game.make_null_move();
+    const auto expected = chess::Board::from_fen(
+        "rnbqkbnr/pppp1ppp/8/3Pp3/8/8/PPP1PPPP/RNBQKBNR b KQkq - 0 2");
+    if (game.board().key() != expected.key()) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_unmake_move() {
+  bool failed = false;
+
+  // A null move is taken back on its own too.
+  for (const auto &fen : move_test_fens) {
+    chess::Game game(fen);
+    if (walk_moves(game, 2, [](chess::Game &game) {
+          const auto after = game.board();
+          game.make_null_move();
+          game.unmake_move();
+          return game.board() != after || game.board().fen() != after.fen();
+        })) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_repetition() {
+  bool failed = false;
+
+  // Shuffling knights back to the start twice repeats it a third time, even
+  // though the move clocks differ.
+  {
+    const chess::Move shuffle[] = {
+        chess::Move(chess::Square(6, 0), chess::Square(5, 2)),
+        chess::Move(chess::Square(6, 7), chess::Square(5, 5)),
+        chess::Move(chess::Square(5, 2), chess::Square(6, 0)),
+        chess::Move(chess::Square(5, 5), chess::Square(6, 7)),
+    };
+
+    chess::Game game;
+    for (auto round = 0; round < 2; round++) {
+      for (const auto move : shuffle) {
+        if (game.drawn()) {
+          failed = true;
+        }
+        game.make_move(move);
+      }
+    }
+
+    if (!game.drawn()) {
+      failed = true;
+    }
+
+    game.unmake_move();
+    if (game.drawn()) {
+      failed = true;
+    }
+  }
+
+  // A double push no pawn can take en passant doesn't make its position
+  // differ from the same one reached later.
+  {
+    const chess::Move moves[] = {
+        chess::Move(chess::Square(4, 1), chess::Square(4, 3),
+                    chess::kMoveDoublePush),
+        chess::Move(chess::Square(6, 7), chess::Square(5, 5)),
+        chess::Move(chess::Square(6, 0), chess::Square(5, 2)),
+        chess::Move(chess::Square(5, 5), chess::Square(6, 7)),
+        chess::Move(chess::Square(5, 2), chess::Square(6, 0)),
+        chess::Move(chess::Square(6, 7), chess::Square(5, 5)),
+        chess::Move(chess::Square(6, 0), chess::Square(5, 2)),
+        chess::Move(chess::Square(5, 5), chess::Square(6, 7)),
+        chess::Move(chess::Square(5, 2), chess::Square(6, 0)),
+    };
+
+    chess::Game game;
+    for (const auto move : moves) {
+      if (game.drawn()) {
+        failed = true;
+      }
+      game.make_move(move);
+    }
+
+    if (!game.drawn()) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_board_after() {
+  bool failed = false;
+
+  // Copy-make gives the same board as making the move on a game, and leaves
+  // the original alone.
+  chess::MoveGenerator generator;
+  for (const auto &fen : move_test_fens) {
+    chess::Game game(fen);
+    for (auto move : generator.generate_legal_moves(game.board())) {
+      const auto before = game.board();
+      const auto after = game.board().after(move);
+      if (game.board() != before) {
+        std::cerr << "Board after changed the original for " << fen
+                  << std::endl;
+        failed = true;
+      }
+
+      game.make_move(move);
+      if (after != game.board() || after.fen() != game.board().fen()) {
+        std::cerr << "Board after test failed for " << fen << std::endl;
+        failed = true;
+      }
+      game.unmake_move();
+    }
+
+    if (game.board() != chess::Board::from_fen(fen)) {
+      std::cerr << "Board after unmake test failed for " << fen << std::endl;
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_stalemate() {
+  bool failed = false;
+
+  // No legal moves is only a draw when not in check.
+  if (!chess::Game("7k/5Q2/8/8/8/8/8/K7 b - - 0 1").drawn() ||
+      chess::Game("7k/6Q1/6K1/8/8/8/8/8 b - - 0 1").drawn()) {
+    failed = true;
+  }
+
+  return failed;
+}
+
+int main() {
+  bool failed = false;
+
+  if (test_fen()) {
+    std::cerr << "FEN test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_castling_rights()) {
+    std::cerr << "Castling rights test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_castling()) {
+    std::cerr << "Castling move test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_promotion()) {
+    std::cerr << "Promotion move test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_en_passant_capture()) {
+    std::cerr << "En passant capture test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_piece_mailbox()) {
+    std::cerr << "Piece mailbox test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_zobrist_key()) {
+    std::cerr << "Zobrist key test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_unmake_move()) {
+    std::cerr << "Unmake move test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_board_after()) {
+    std::cerr << "Board after test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_repetition()) {
+    std::cerr << "Repetition test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_stalemate()) {
+    std::cerr << "Stalemate test failed" << std::endl;
+    failed = true;
+  }
+
+  return failed;
+}
@@ -1,365 +1,737 @@
-#include <bitset>
-#include <iostream>
-
-#include <libchess/game.h>
-#include <libchess/move_generator.h>
-
-int count_moves(const chess::Board board) {
-  chess::MoveGenerator move_generator;
-  auto moves = move_generator.generate_pseudolegal_moves(board);
-
-  return moves.size();
-}
-
-int count_legal_moves(const chess::Board board) {
-  chess::Game game(board);
-  chess::MoveGenerator move_generator;
-  auto moves = move_generator.generate_legal_moves(game);
-
-  return moves.size();
-}
-
-int count_castling_moves(const chess::Board board) {
-  chess::Game game(board);
-  chess::MoveGenerator move_generator;
-  auto moves = move_generator.generate_legal_moves(game);
-  int castling_moves = 0;
-  for (auto move : moves.moves()) {
-    if (move.null()) {
-      break;
-    }
-
-    if (move.castling(board)) {
-      castling_moves++;
-    }
-  }
-
-  return castling_moves;
-}
-
-bool test_pawn_moves() {
-  bool failed = false;
-
-  // A single row of pawns in their starting rank - should always be 8 single
-  // moves and 8 double moves.
-  {
-    auto board = chess::Board::from_fen("8/8/8/8/8/8/PPPPPPPP/8 w - - 0 1");
-    if (count_moves(board) != 16) {
-      failed = true;
-    }
-  }
-
-  // Same as above but with black pieces.
-  {
-    auto board = chess::Board::from_fen("8/pppppppp/8/8/8/8/8/8 b - - 0 1");
-    if (count_moves(board) != 16) {
-      failed = true;
-    }
-  }
-
-  // Single pawn with two moves and two captures.
-  {
-    auto board = chess::Board::from_fen("8/8/8/8/8/q1q5/1P6/8 w - - 0 1");
-    if (count_moves(board) != 4) {
-      failed = true;
-    }
-  }
-
-  // Single pawn with no moves and two captures.
-  {
-    auto board = chess::Board::from_fen("8/8/8/8/8/qqq5/1P6/8 w - - 0 1");
-    if (count_moves(board) != 2) {
-      failed = true;
-    }
-  }
-
-  // En passant capture possible on g6
-  {
-    auto board = chess::Board::from_fen("8/8/8/5Pp1/8/8/8/8 w - g6 0 1");
-    if (count_moves(board) != 2) {
-      failed = true;
-    }
-  }
-
-  // Same as above but for black.
-  {
-    auto board = chess::Board::from_fen("8/8/8/8/Pp6/8/8/8 b - a3 0 1");
-    if (count_moves(board) != 2) {
-      failed = true;
-    }
-  }
-
-  // En passant is possible but no piece is around to capture.
-  {
-    auto board = chess::Board::from_fen("8/8/8/8/P6p/8/8/8 b - a3 0 1");
-    if (count_moves(board) != 1) {
-      failed = true;
-    }
-  }
-
-  return failed;
-}
-
-bool test_knight_moves() {
-  bool failed = false;
-
-  // Single knight in the corner of the board - should always be two moves.
-  {
-    auto board = chess::Board::from_fen("8/8/8/8/8/8/8/N7 w - - 0 1");
-    if (count_moves(board) != 2) {
-      failed = true;
-    }
-  }
-
-  return failed;
-}
-
-bool test_bishop_moves() {
-  bool failed = false;
-
-  // Single bishop in the bottom right corner of the board - should always be 7
-  // moves.
-  {
-    auto board = chess::Board::from_fen("8/8/8/8/8/8/8/B7 w - - 0 1");
-    if (count_moves(board) != 7) {
-      failed = true;
-    }
-  }
-
-  // Bishop near the center of the board - should always be 13 moves.
-  {
-    auto board = chess::Board::from_fen("8/8/8/4B3/8/8/8/8 w - - 0 1");
-    if (count_moves(board) != 13) {
-      failed = true;
-    }
-  }
-
-  // Surrounded bishop. 4 possible captures.
-  {
-    auto board = chess::Board::from_fen("8/8/8/2q1q3/3B4/2q1q3/8/8 w - - 0 1");
-    if (count_moves(board) != 4) {
-      failed = true;
-    }
-  }
-
-  return failed;
-}
-
-bool test_rook_moves() {
-  bool failed = false;
-
-  // Single rook in the corner of the board - should always be 14 moves.
-  {
-    auto board = chess::Board::from_fen("8/8/8/8/8/8/8/R7 w - - 0 1");
-    if (count_moves(board) != 14) {
-      failed = true;
-    }
-  }
-
-  // Two rooks in the corner - should always be 20 moves
-  {
-    auto board = chess::Board::from_fen("8/8/8/8/8/8/8/RR6 w - - 0 1");
-    if (count_moves(board) != 20) {
-      failed = true;
-    }
-  }
-
-  return failed;
-}
-
-bool test_queen_moves() {
-  bool failed = false;
-
-  // Queen in the center of an empty board. Should always be 27 moves.
-  {
-    auto board = chess::Board::from_fen("8/8/8/8/3Q4/8/8/8 w - - 0 1");
-    if (count_moves(board) != 27) {
-      failed = true;
-    }
-  }
-
-  // Surrounded queen. 8 possible captures.
-  {
-    auto board =
-        chess::Board::from_fen("8/8/8/2qqq3/2qQq3/2qqq3/8/8 w - - 0 1");
-    if (count_moves(board) != 8) {
-      failed = true;
-    }
-  }
-
-  return failed;
-}
-
-bool test_king_moves() {
-  bool failed = false;
-
-  // King in the center of an empty board. Should always be 8 moves.
-  {
-    auto board = chess::Board::from_fen("8/8/8/4K3/8/8/8/8 w - - 0 1");
-    if (count_moves(board) != 8) {
-      failed = true;
-    }
-  }
-
-  {
-    auto board = chess::Board::from_fen("K7/2k5/8/8/8/8/8/8 w - - 0 1");
-    if (count_legal_moves(board) != 1) {
-      failed = true;
-    }
-  }
-
-  {
-    auto board = chess::Board::from_fen("8/b1k1b3/8/2K5/8/8/8/8 w - - 0 1");
-    if (count_legal_moves(board) != 3) {
-      failed = true;
-    }
-  }
-
-  {
-    auto board = chess::Board::from_fen("8/2k5/3q4/2K5/2Q5/8/8/8 w - - 0 1");
-    if (count_legal_moves(board) != 1) {
-      failed = true;
-    }
-  }
-
-  {
-      auto board = chess::Board::from_fen("8/8/8/2k5/3Pp3/8/8/4K3 b - d3 0 1");
-      auto moves = count_legal_moves(board);
-      std::cout << "moves: " << moves << std::endl;
-  }
-
-  return failed;
-}
-
-bool test_castling_moves() {
-  bool failed = false;
-
-  // White can castle kingside.
-  {
-    auto board = chess::Board::from_fen("8/8/8/8/8/8/8/4K2R w K - 0 1");
-    if (count_castling_moves(board) != 1) {
-      failed = true;
-    }
-  }
-
-  // White has kingside castling rights but castling is blocked by a piece.
-  {
-    auto board = chess::Board::from_fen("8/8/8/8/8/8/8/4KN1R w K - 0 1");
-    if (count_castling_moves(board) != 0) {
-      failed = true;
-    }
-  }
-
-  // Black can castle on either side, but it's queenside castle is blocked by an
-  // attacking piece
-  {
-    auto board = chess::Board::from_fen("r3k2r/8/8/8/8/8/8/1Q6 b KQkq - 0 1");
-    if (count_castling_moves(board) != 1) {
-      failed = true;
-    }
-  }
-
-  return failed;
-}
-
-bool test_pin_moves() {
-  bool failed = false;
-
-  // Bishop pinned by queen. The king can make 5 legal moves.
-  {
-    auto board = chess::Board::from_fen("8/8/8/8/2qBK3/8/8/8 w - - 0 1");
-    if (count_legal_moves(board) != 5) {
-      failed = true;
-    }
-  }
-
-  {
-    auto board = chess::Board::from_fen(
-        "r1bqkbnr/ppp2ppp/2np4/1B2p3/4P3/5N2/PPPP1PPP/RN1QKB1R b KQkq - 0 1");
-    if (count_legal_moves(board) != 27) {
-      failed = true;
-    }
-  }
-
-  return failed;
-}
-
-bool test_promotion_moves() {
-  bool failed = false;
-
-  {
-    auto board = chess::Board::from_fen("8/2P5/8/8/8/8/8/8 w - - 0 1");
-    if (count_moves(board) != 4) {
-      failed = true;
-    }
-  }
-
-  // Promotion either by pushing or capturing
-  {
-    auto board = chess::Board::from_fen("3q4/2P5/8/8/8/8/8/8 w - - 0 1");
-    if (count_moves(board) != 8) {
-      failed = true;
-    }
-  }
-
-  // Promotion blocked
-  {
-    auto board = chess::Board::from_fen("2k5/2P5/8/8/8/8/8/8 w - - 0 1");
-    if (count_moves(board) != 0) {
-      failed = true;
-    }
-  }
-
-  return failed;
-}
-
-int main() {
-  bool failed = false;
-
-  if (test_pawn_moves()) {
-    std::cerr << "Pawn move generation test failed" << std::endl;
-    failed = true;
-  }
-
-  if (test_knight_moves()) {
-    std::cerr << "Knight move generation test failed" << std::endl;
-    failed = true;
-  }
-
-  if (test_bishop_moves()) {
-    std::cerr << "Bishop move generation test failed" << std::endl;
-    failed = true;
-  }
-
-  if (test_rook_moves()) {
-    std::cerr << "Rook move generation test failed" << std::endl;
-    failed = true;
-  }
-
-  if (test_queen_moves()) {
-    std::cerr << "Queen move generation test failed" << std::endl;
-    failed = true;
-  }
-
-  if (test_king_moves()) {
-    std::cerr << "King move generation test failed" << std::endl;
-    failed = true;
-  }
-
-  if (test_castling_moves()) {
-    std::cerr << "Castling move generation test failed" << std::endl;
-    failed = true;
-  }
-
-  if (test_pin_moves()) {
-    std::cerr << "Pinned piece move generation test failed" << std::endl;
-    failed = true;
-  }
-
-  if (test_promotion_moves()) {
-    std::cerr << "Promotion move generation test failed" << std::endl;
-    failed = true;
-  }
-
-  return failed;
-}
\ No newline at end of file
+#include <bitset>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include <libchess/game.h>
+#include <libchess/move_generator.h>
+#include <libchess/perft.h>
+
+// Positions for tests over the whole generator, with their perft counts three
+// plies deep. Between them they reach castling, en passant, pins, checks and
+// every kind of promotion.
+const struct {
+  const char *fen;
+  uint64_t nodes;
+} standard_positions[] = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 8902},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+     97862},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 2812},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 9467},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 62379},
+    {"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 21637},
+};
+
+int count_moves(const chess::Board board) {
+  chess::MoveGenerator move_generator;
+  auto moves = move_generator.generate_pseudolegal_moves(board);
+
+  return moves.size();
+}
+
+int count_legal_moves(const chess::Board board) {
+  chess::Game game(board);
+  chess::MoveGenerator move_generator;
+  auto moves = move_generator.generate_legal_moves(game);
+
+  return moves.size();
+}
+
+int count_castling_moves(const chess::Board board) {
+  chess::Game game(board);
+  chess::MoveGenerator move_generator;
+  auto moves = move_generator.generate_legal_moves(game);
+  int castling_moves = 0;
+  for (auto move : moves) {
+    if (move.castling()) {
+      castling_moves++;
+    }
+  }
+
+  return castling_moves;
+}
+
+bool test_pawn_moves() {
+  bool failed = false;
+
+  // A single row of pawns in their starting rank - should always be 8 single
+  // moves and 8 double moves.
+  {
+    auto board = chess::Board::from_fen("8/8/8/8/8/8/PPPPPPPP/8 w - - 0 1");
+    if (count_moves(board) != 16) {
+      failed = true;
+    }
+  }
+
+  // Same as above but with black pieces.
+  {
+    auto board = chess::Board::from_fen("8/pppppppp/8/8/8/8/8/8 b - - 0 1");
+    if (count_moves(board) != 16) {
+      failed = true;
+    }
+  }
+
+  // Single pawn with two moves and two captures.
+  {
+    auto board = chess::Board::from_fen("8/8/8/8/8/q1q5/1P6/8 w - - 0 1");
+    if (count_moves(board) != 4) {
+      failed = true;
+    }
+  }
+
+  // Single pawn with no moves and two captures.
+  {
+    auto board = chess::Board::from_fen("8/8/8/8/8/qqq5/1P6/8 w - - 0 1");
+    if (count_moves(board) != 2) {
+      failed = true;
+    }
+  }
+
+  // En passant capture possible on g6
+  {
+    auto board = chess::Board::from_fen("8/8/8/5Pp1/8/8/8/8 w - g6 0 1");
+    if (count_moves(board) != 2) {
+      failed = true;
+    }
+  }
+
+  // Same as above but for black.
+  {
+    auto board = chess::Board::from_fen("8/8/8/8/Pp6/8/8/8 b - a3 0 1");
+    if (count_moves(board) != 2) {
+      failed = true;
+    }
+  }
+
+  // En passant is possible but no piece is around to capture.
+  {
+    auto board = chess::Board::from_fen("8/8/8/8/P6p/8/8/8 b - a3 0 1");
+    if (count_moves(board) != 1) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_knight_moves() {
+  bool failed = false;
+
+  // Single knight in the corner of the board - should always be two moves.
+  {
+    auto board = chess::Board::from_fen("8/8/8/8/8/8/8/N7 w - - 0 1");
+    if (count_moves(board) != 2) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_bishop_moves() {
+  bool failed = false;
+
+  // Single bishop in the bottom right corner of the board - should always be 7
+  // moves.
+  {
+    auto board = chess::Board::from_fen("8/8/8/8/8/8/8/B7 w - - 0 1");
+    if (count_moves(board) != 7) {
+      failed = true;
+    }
+  }
+
+  // Bishop near the center of the board - should always be 13 moves.
+  {
+    auto board = chess::Board::from_fen("8/8/8/4B3/8/8/8/8 w - - 0 1");
+    if (count_moves(board) != 13) {
+      failed = true;
+    }
+  }
+
+  // Surrounded bishop. 4 possible captures.
+  {
+    auto board = chess::Board::from_fen("8/8/8/2q1q3/3B4/2q1q3/8/8 w - - 0 1");
+    if (count_moves(board) != 4) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_rook_moves() {
+  bool failed = false;
+
+  // Single rook in the corner of the board - should always be 14 moves.
+  {
+    auto board = chess::Board::from_fen("8/8/8/8/8/8/8/R7 w - - 0 1");
+    if (count_moves(board) != 14) {
+      failed = true;
+    }
+  }
+
+  // Two rooks in the corner - should always be 20 moves
+  {
+    auto board = chess::Board::from_fen("8/8/8/8/8/8/8/RR6 w - - 0 1");
+    if (count_moves(board) != 20) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_queen_moves() {
+  bool failed = false;
+
+  // Queen in the center of an empty board. Should always be 27 moves.
+  {
+    auto board = chess::Board::from_fen("8/8/8/8/3Q4/8/8/8 w - - 0 1");
+    if (count_moves(board) != 27) {
+      failed = true;
+    }
+  }
+
+  // Surrounded queen. 8 possible captures.
+  {
+    auto board =
+        chess::Board::from_fen("8/8/8/2qqq3/2qQq3/2qqq3/8/8 w - - 0 1");
+    if (count_moves(board) != 8) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_king_moves() {
+  bool failed = false;
+
+  // King in the center of an empty board. Should always be 8 moves.
+  {
+    auto board = chess::Board::from_fen("8/8/8/4K3/8/8/8/8 w - - 0 1");
+    if (count_moves(board) != 8) {
+      failed = true;
+    }
+  }
+
+  {
+    auto board = chess::Board::from_fen("K7/2k5/8/8/8/8/8/8 w - - 0 1");
+    if (count_legal_moves(board) != 1) {
+      failed = true;
+    }
+  }
+
+  {
+    auto board = chess::Board::from_fen("8/b1k1b3/8/2K5/8/8/8/8 w - - 0 1");
+    if (count_legal_moves(board) != 3) {
+      failed = true;
+    }
+  }
+
+  {
+    auto board = chess::Board::from_fen("8/2k5/3q4/2K5/2Q5/8/8/8 w - - 0 1");
+    if (count_legal_moves(board) != 1) {
+      failed = true;
+    }
+  }
+
+  // En passant capture of the checking pawn, plus 8 king moves.
+  {
+    auto board = chess::Board::from_fen("8/8/8/2k5/3Pp3/8/8/4K3 b - d3 0 1");
+    if (count_legal_moves(board) != 9) {
+      failed = true;
+    }
+  }
+
+  // Double check by a knight and a rook. Only the king can move.
+  {
+    auto board = chess::Board::from_fen("4r2k/8/8/8/8/3n4/7R/4K3 w - - 0 1");
+    if (count_legal_moves(board) != 3) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_castling_moves() {
+  bool failed = false;
+
+  // White can castle kingside.
+  {
+    auto board = chess::Board::from_fen("8/8/8/8/8/8/8/4K2R w K - 0 1");
+    if (count_castling_moves(board) != 1) {
+      failed = true;
+    }
+  }
+
+  // White has kingside castling rights but castling is blocked by a piece.
+  {
+    auto board = chess::Board::from_fen("8/8/8/8/8/8/8/4KN1R w K - 0 1");
+    if (count_castling_moves(board) != 0) {
+      failed = true;
+    }
+  }
+
+  // Black can castle on either side, but it's queenside castle is blocked by an
+  // attacking piece
+  {
+    auto board = chess::Board::from_fen("r3k2r/8/8/8/8/8/8/2Q5 b KQkq - 0 1");
+    if (count_castling_moves(board) != 1) {
+      failed = true;
+    }
+  }
+
+  // The king never crosses b8, so an attack on it doesn't stop the queenside
+  // castle.
+  {
+    auto board = chess::Board::from_fen("r3k2r/8/8/8/8/8/8/1Q6 b KQkq - 0 1");
+    if (count_castling_moves(board) != 2) {
+      failed = true;
+    }
+  }
+
+  // No castling out of check.
+  {
+    auto board = chess::Board::from_fen("r3k2r/8/8/8/8/8/8/4Q3 b KQkq - 0 1");
+    if (count_castling_moves(board) != 0) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_pin_moves() {
+  bool failed = false;
+
+  // Bishop pinned by queen. The king can make 5 legal moves.
+  {
+    auto board = chess::Board::from_fen("8/8/8/8/2qBK3/8/8/8 w - - 0 1");
+    if (count_legal_moves(board) != 5) {
+      failed = true;
+    }
+  }
+
+  {
+    auto board = chess::Board::from_fen(
+        "r1bqkbnr/ppp2ppp/2np4/1B2p3/4P3/5N2/PPPP1PPP/RN1QKB1R b KQkq - 0 1");
+    if (count_legal_moves(board) != 27) {
+      failed = true;
+    }
+  }
+
+  // Pawn pinned on a diagonal can only capture the pinning bishop.
+  {
+    auto board = chess::Board::from_fen("8/8/8/8/8/5b2/4P3/3K4 w - - 0 1");
+    if (count_legal_moves(board) != 5) {
+      failed = true;
+    }
+  }
+
+  // En passant would remove both pawns from the king's rank and expose it to
+  // the rook.
+  {
+    auto board = chess::Board::from_fen("8/8/8/KPp4r/8/8/8/7k w - c6 0 1");
+    if (count_legal_moves(board) != 4) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_promotion_moves() {
+  bool failed = false;
+
+  {
+    auto board = chess::Board::from_fen("8/2P5/8/8/8/8/8/8 w - - 0 1");
+    if (count_moves(board) != 4) {
+      failed = true;
+    }
+  }
+
+  // Promotion either by pushing or capturing
+  {
+    auto board = chess::Board::from_fen("3q4/2P5/8/8/8/8/8/8 w - - 0 1");
+    if (count_moves(board) != 8) {
+      failed = true;
+    }
+  }
+
+  // Promotion blocked
+  {
+    auto board = chess::Board::from_fen("2k5/2P5/8/8/8/8/8/8 w - - 0 1");
+    if (count_moves(board) != 0) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_perft() {
+  bool failed = false;
+
+  for (const auto &position : standard_positions) {
+    const auto nodes = chess::perft(chess::Board::from_fen(position.fen), 3);
+    if (nodes != position.nodes) {
+      std::cerr << "Perft mismatch for " << position.fen << ": " << nodes
+                << " != " << position.nodes << std::endl;
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool contains(const chess::MoveList &moves, const chess::Move move) {
+  for (auto i = 0; i < moves.size(); i++) {
+    if (moves.move(i) == move) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Checks every generation mode against the full legal move list on |game|
+// and the positions below it.
+bool check_generation_modes(chess::Game &game, int depth) {
+  chess::MoveGenerator move_generator;
+  const auto board = game.board();
+  const auto legal = move_generator.generate<chess::kLegal>(board);
+  const auto captures = move_generator.generate<chess::kCaptures>(board);
+  const auto quiets = move_generator.generate<chess::kQuiets>(board);
+  const auto quiet_checks = move_generator.generate<chess::kQuietChecks>(board);
+
+  if (captures.size() + quiets.size() != legal.size()) {
+    return true;
+  }
+
+  int expected_quiet_checks = 0;
+  for (auto i = 0; i < legal.size(); i++) {
+    const auto move = legal.move(i);
+    if (!contains(captures, move) && !contains(quiets, move)) {
+      return true;
+    }
+
+    if (contains(quiets, move) && !move.castling()) {
+      game.make_move(move);
+      const auto check = game.board().check(game.board().turn());
+      game.unmake_move();
+
+      if (check) {
+        expected_quiet_checks++;
+        if (!contains(quiet_checks, move)) {
+          return true;
+        }
+      }
+    }
+  }
+
+  if (quiet_checks.size() != expected_quiet_checks) {
+    return true;
+  }
+
+  if (board.check(board.turn())) {
+    const auto evasions = move_generator.generate<chess::kEvasions>(board);
+    if (evasions.size() != legal.size()) {
+      return true;
+    }
+  }
+
+  if (depth > 1) {
+    for (auto i = 0; i < legal.size(); i++) {
+      game.make_move(legal.move(i));
+      const auto failed = check_generation_modes(game, depth - 1);
+      game.unmake_move();
+
+      if (failed) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+bool test_generation_modes() {
+  bool failed = false;
+
+  for (const auto &position : standard_positions) {
+    const auto fen = position.fen;
+    chess::Game game(fen);
+    if (check_generation_modes(game, 2)) {
+      std::cerr << "Generation modes disagree below " << fen << std::endl;
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_uci_moves() {
+  bool failed = false;
+
+  // Every legal move survives a round trip through UCI notation.
+  chess::MoveGenerator generator;
+  for (const auto &position : standard_positions) {
+    const auto fen = position.fen;
+    const auto board = chess::Board::from_fen(fen);
+    const auto moves = generator.generate_legal_moves(board);
+    for (auto i = 0; i < moves.size(); i++) {
+      char uci[6];
+      const auto length = moves.move(i).write_uci(uci);
+      if (length != std::string(uci).size() ||
+          chess::Move::from_uci(board, std::string_view(uci, length)) !=
+              moves.move(i)) {
+        std::cerr << "UCI round trip failed for " << uci << " in " << fen
+                  << std::endl;
+        failed = true;
+      }
+    }
+  }
+
+  {
+    const auto board = chess::Board::from_fen(
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 b kq - 0 1");
+    const auto promotion = chess::Move::from_uci(board, "b2a1n");
+    char uci[6];
+    if (promotion != chess::Move(chess::Square(1, 1), chess::Square(0, 0),
+                                 chess::kPromoteKnight, true) ||
+        promotion.write_uci(uci) != 5 || std::string(uci) != "b2a1n") {
+      std::cerr << "UCI promotion test failed" << std::endl;
+      failed = true;
+    }
+
+    const char *malformed[] = {"", "e2", "e2e", "e2e9", "i2e4", "e2e4q",
+                               "b7a8x", "0000", "e2e4e2e4"};
+    for (auto text : malformed) {
+      if (!chess::Move::from_uci(board, text).null()) {
+        std::cerr << "Parsed malformed UCI move " << text << std::endl;
+        failed = true;
+      }
+    }
+  }
+
+  return failed;
+}
+
+bool test_move_flags() {
+  bool failed = false;
+
+  struct FlagCounts {
+    const char *fen;
+    int double_pushes;
+    int captures;
+    int en_passants;
+    int castles;
+    int promotions;
+  };
+  const FlagCounts cases[] = {
+      {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 8, 0, 0, 0,
+       0},
+      {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+       2, 8, 0, 2, 0},
+      {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 6, 0, 1,
+       4},
+      {"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 0 3", 7, 1, 1,
+       0, 0},
+  };
+
+  chess::MoveGenerator generator;
+  for (const auto &test_case : cases) {
+    const auto board = chess::Board::from_fen(test_case.fen);
+    const auto moves = generator.generate_legal_moves(board);
+    FlagCounts counts = {test_case.fen, 0, 0, 0, 0, 0};
+    for (auto i = 0; i < moves.size(); i++) {
+      const auto move = moves.move(i);
+      counts.double_pushes += move.double_push();
+      counts.captures += move.capture();
+      counts.en_passants += move.en_passant();
+      counts.castles += move.castling();
+      counts.promotions += move.promotes();
+    }
+
+    if (counts.double_pushes != test_case.double_pushes ||
+        counts.captures != test_case.captures ||
+        counts.en_passants != test_case.en_passants ||
+        counts.castles != test_case.castles ||
+        counts.promotions != test_case.promotions) {
+      std::cerr << "Move flag test failed for " << test_case.fen << std::endl;
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_move_list() {
+  bool failed = false;
+
+  chess::MoveGenerator generator;
+  auto moves = generator.generate_legal_moves(chess::Board::from_fen(
+      "R6R/3Q4/1Q4Q1/4Q3/2Q4Q/Q4Q2/pp1Q4/kBNN1KB1 w - - 0 1"));
+  if (moves.size() != chess::max_moves) {
+    std::cerr << "Move list capacity test failed" << std::endl;
+    failed = true;
+  }
+
+  for (auto i = 0; i < moves.size(); i++) {
+    moves.set_score(i, moves.move(i).to().index());
+  }
+
+  // Copies only carry the moves in use, but keep their scores.
+  const auto copy = moves;
+  int iterated = 0;
+  for (auto move : copy) {
+    if (move != moves.move(iterated) ||
+        copy.score(iterated) != moves.score(iterated)) {
+      failed = true;
+    }
+    iterated++;
+  }
+  if (iterated != moves.size()) {
+    failed = true;
+  }
+
+  // Picking every move in turn sorts them by score, each move keeping its own.
+  int last_score = 64;
+  for (auto i = 0; i < moves.size(); i++) {
+    const auto move = moves.pick_best(i);
+    if (moves.score(i) > last_score || moves.score(i) != move.to().index()) {
+      std::cerr << "Move list selection test failed" << std::endl;
+      failed = true;
+      break;
+    }
+    last_score = moves.score(i);
+  }
+
+  return failed;
+}
+
+// Checks count_legal_moves() against the generated moves on |board| and the
+// positions below it.
+bool check_move_counts(const chess::Board &board, int depth) {
+  chess::MoveGenerator generator;
+  const auto moves = generator.generate_legal_moves(board);
+  if (generator.count_legal_moves(board) != moves.size()) {
+    std::cerr << "Move count mismatch for " << board.fen() << std::endl;
+    return true;
+  }
+
+  if (depth > 1) {
+    for (auto move : moves) {
+      if (check_move_counts(board.after(move), depth - 1)) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+bool test_count_legal_moves() {
+  bool failed = false;
+
+  for (const auto &position : standard_positions) {
+    failed |= check_move_counts(chess::Board::from_fen(position.fen), 3);
+  }
+
+  const char *fens[] = {
+      // Pinned pawns that can still push, capture or promote along the pin.
+      "4r1k1/8/8/8/1b6/2P5/4P3/4K3 w - - 0 1",
+      "1b2k3/2P5/3K4/8/8/8/8/8 w - - 0 1",
+      // Stalemate.
+      "7k/5Q2/8/8/8/8/8/K7 b - - 0 1",
+  };
+  for (auto fen : fens) {
+    failed |= check_move_counts(chess::Board::from_fen(fen), 3);
+  }
+
+  return failed;
+}
+
+int main() {
+  bool failed = false;
+
+  if (test_pawn_moves()) {
+    std::cerr << "Pawn move generation test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_knight_moves()) {
+    std::cerr << "Knight move generation test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_bishop_moves()) {
+    std::cerr << "Bishop move generation test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_rook_moves()) {
+    std::cerr << "Rook move generation test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_queen_moves()) {
+    std::cerr << "Queen move generation test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_king_moves()) {
+    std::cerr << "King move generation test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_castling_moves()) {
+    std::cerr << "Castling move generation test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_pin_moves()) {
+    std::cerr << "Pinned piece move generation test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_promotion_moves()) {
+    std::cerr << "Promotion move generation test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_generation_modes()) {
+    std::cerr << "Generation mode test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_perft()) {
+    std::cerr << "Perft test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_uci_moves()) {
+    std::cerr << "UCI move test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_move_flags()) {
+    std::cerr << "Move flag test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_move_list()) {
+    std::cerr << "Move list test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_count_legal_moves()) {
+    std::cerr << "Legal move count test failed" << std::endl;
+    failed = true;
+  }
+
+  return failed;
+}
@@ -0,0 +1,139 @@
+#include <iostream>
+#include <vector>
+
+#include <libchess/move_generator.h>
+#include <libchess/move_picker.h>
+
+constexpr const char *test_fens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "8/8/8/2k5/3Pp3/8/8/4K3 b - d3 0 1",
+};
+
+std::vector<chess::Move> pick_all(chess::MovePicker &picker) {
+  std::vector<chess::Move> moves;
+  for (auto move = picker.next(); !move.null(); move = picker.next()) {
+    moves.push_back(move);
+  }
+
+  return moves;
+}
+
+bool same_moves(const std::vector<chess::Move> &picked,
+                const chess::MoveList &expected) {
+  if (static_cast<int>(picked.size()) != expected.size()) {
+    return false;
+  }
+
+  for (auto i = 0; i < expected.size(); i++) {
+    auto count = 0;
+    for (auto move : picked) {
+      if (move == expected.move(i)) {
+        count++;
+      }
+    }
+
+    if (count != 1) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool test_all_moves() {
+  bool failed = false;
+
+  // Every legal move comes out of the picker exactly once, with or without
+  // a best move and killers.
+  for (auto fen : test_fens) {
+    auto board = chess::Board::from_fen(fen);
+    chess::MoveGenerator move_generator;
+    auto legal_moves = move_generator.generate_legal_moves(board);
+
+    chess::MovePicker picker(board);
+    if (!same_moves(pick_all(picker), legal_moves)) {
+      std::cerr << "Picker moves differ for " << fen << std::endl;
+      failed = true;
+    }
+
+    auto best = legal_moves.move(legal_moves.size() - 1);
+    auto killer = legal_moves.move(0);
+    chess::MovePicker ordered_picker(board, best, killer, killer);
+    auto picked = pick_all(ordered_picker);
+    if (!same_moves(picked, legal_moves) || picked[0] != best) {
+      std::cerr << "Ordered picker moves differ for " << fen << std::endl;
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_ordering() {
+  bool failed = false;
+
+  // Queen and pawn both hang to the knight and the rook. Knight takes queen
+  // must come first, and pawn captures must come before any quiet move.
+  {
+    auto board = chess::Board::from_fen("4k3/8/3q4/8/2N5/8/8/3RK3 w - - 0 1");
+    chess::MovePicker picker(board);
+    auto first = picker.next();
+    if (first != chess::Move(chess::Square(2, 3), chess::Square(3, 5),
+                             chess::kMoveCapture)) {
+      failed = true;
+    }
+
+    auto second = picker.next();
+    if (second != chess::Move(chess::Square(3, 0), chess::Square(3, 5),
+                              chess::kMoveCapture)) {
+      failed = true;
+    }
+
+    if (picker.next().capture()) {
+      failed = true;
+    }
+  }
+
+  // Queen promotion before underpromotions.
+  {
+    auto board = chess::Board::from_fen("4k3/1P6/8/8/8/8/8/4K3 w - - 0 1");
+    chess::MovePicker picker(board);
+    if (picker.next().promotion_piece_type() != chess::kPieceQueen) {
+      failed = true;
+    }
+  }
+
+  // An illegal best move and a killer that isn't a quiet move are skipped.
+  {
+    auto board = chess::Board::from_fen("4k3/8/8/8/8/8/8/4K3 w - - 0 1");
+    auto illegal = chess::Move(chess::Square(4, 0), chess::Square(4, 2));
+    auto killer = chess::Move(chess::Square(4, 0), chess::Square(3, 1));
+    chess::MovePicker picker(board, illegal, illegal, killer);
+    auto picked = pick_all(picker);
+    if (picked.size() != 5 || picked[0] != killer) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+int main() {
+  bool failed = false;
+
+  if (test_all_moves()) {
+    std::cerr << "Move picker completeness test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_ordering()) {
+    std::cerr << "Move picker ordering test failed" << std::endl;
+    failed = true;
+  }
+
+  return failed;
+}
@@ -0,0 +1,168 @@
+#include <stdint.h>
+
+#include <iostream>
+
+#include <libchess/move_generator.h>
+#include <libchess/perft.h>
+
+struct PerftPosition {
+  const char *fen;
+  int depth;
+  uint64_t nodes;
+};
+
+const PerftPosition positions[] = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 4, 197281},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4,
+     4085603},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4,
+     422333},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
+};
+
+bool test_perft() {
+  bool failed = false;
+
+  for (const auto &position : positions) {
+    const auto board = chess::Board::from_fen(position.fen);
+    const auto nodes = chess::perft(board, position.depth);
+    if (nodes != position.nodes) {
+      std::cerr << "Perft mismatch for " << position.fen << ": " << nodes
+                << " != " << position.nodes << std::endl;
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+bool test_parallel_perft() {
+  bool failed = false;
+
+  // Thread counts that divide the work unevenly must still add up exactly.
+  for (const auto &position : positions) {
+    const auto board = chess::Board::from_fen(position.fen);
+    for (auto threads : {2, 3, 8}) {
+      const auto nodes = chess::parallel_perft(board, position.depth, threads);
+      if (nodes != position.nodes) {
+        std::cerr << "Parallel perft mismatch with " << threads
+                  << " threads for " << position.fen << ": " << nodes
+                  << " != " << position.nodes << std::endl;
+        failed = true;
+      }
+    }
+  }
+
+  return failed;
+}
+
+bool test_hashed_perft() {
+  bool failed = false;
+
+  // A cache this small keeps overwriting entries, so replacement is tested
+  // along with hits. Positions are counted twice, the second time mostly
+  // from the cache.
+  chess::PerftCache cache(1);
+  for (auto pass = 0; pass < 2; pass++) {
+    for (const auto &position : positions) {
+      const auto board = chess::Board::from_fen(position.fen);
+      const auto nodes = chess::perft(board, position.depth, &cache);
+      const auto parallel_nodes =
+          chess::parallel_perft(board, position.depth, 3, &cache);
+      if (nodes != position.nodes || parallel_nodes != position.nodes) {
+        std::cerr << "Hashed perft mismatch for " << position.fen << ": "
+                  << nodes << ", " << parallel_nodes
+                  << " != " << position.nodes << std::endl;
+        failed = true;
+      }
+    }
+  }
+
+  return failed;
+}
+
+bool test_split_perft() {
+  bool failed = false;
+
+  // Splitting down to single plies hands subtrees out at every level, so
+  // subtrees split below other splits. None of their partial counts may
+  // reach the cache, or later passes would read them back.
+  chess::PerftCache cache(16);
+  for (auto pass = 0; pass < 3; pass++) {
+    for (const auto &position : positions) {
+      const auto board = chess::Board::from_fen(position.fen);
+      const auto nodes =
+          chess::parallel_perft(board, position.depth, 4, &cache, 1);
+      if (nodes != position.nodes) {
+        std::cerr << "Split perft mismatch for " << position.fen << ": "
+                  << nodes << " != " << position.nodes << std::endl;
+        failed = true;
+      }
+    }
+  }
+
+  return failed;
+}
+
+bool test_perft_divide() {
+  bool failed = false;
+
+  for (const auto &position : positions) {
+    const auto board = chess::Board::from_fen(position.fen);
+    const auto divisions = chess::perft_divide(board, position.depth, 2);
+    chess::MoveGenerator generator;
+    const auto moves = generator.generate_legal_moves(board);
+    uint64_t nodes = 0;
+    for (auto i = 0; i < static_cast<int>(divisions.size()); i++) {
+      if (i >= moves.size() || divisions[i].move != moves.move(i) ||
+          divisions[i].nodes != chess::perft(board.after(moves.move(i)),
+                                             position.depth - 1)) {
+        std::cerr << "Perft divide mismatch for " << position.fen
+                  << " at move " << i << std::endl;
+        failed = true;
+      }
+      nodes += divisions[i].nodes;
+    }
+
+    if (static_cast<int>(divisions.size()) != moves.size() ||
+        nodes != position.nodes) {
+      std::cerr << "Perft divide total mismatch for " << position.fen << ": "
+                << nodes << " != " << position.nodes << std::endl;
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+int main() {
+  bool failed = false;
+
+  if (test_perft()) {
+    std::cerr << "Perft test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_parallel_perft()) {
+    std::cerr << "Parallel perft test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_hashed_perft()) {
+    std::cerr << "Hashed perft test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_split_perft()) {
+    std::cerr << "Split perft test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_perft_divide()) {
+    std::cerr << "Perft divide test failed" << std::endl;
+    failed = true;
+  }
+
+  return failed;
+}
@@ -0,0 +1,151 @@
+#include <iostream>
+#include <random>
+
+#include <libchess/bitboard_iterator.h>
+#include <libchess/board.h>
+#include <libchess/piece.h>
+
+bool test_slider_attacks() {
+  bool failed = false;
+
+  // Compare the magic bitboard tables against the reference ray scan for a
+  // spread of sparse and dense occupancies on every square.
+  std::mt19937_64 random(0x5eed);
+  for (auto i = 0; i < 2000; i++) {
+    auto occupied = chess::Bitboard(random() & random());
+    if (i % 2) {
+      occupied |= chess::Bitboard(random());
+    }
+
+    for (auto index = 0; index < 64; index++) {
+      auto square = chess::Square(index);
+      if (chess::bishop_attack_board(occupied, square) !=
+          chess::bishop_ray_attack_board(occupied, square)) {
+        std::cerr << "Bishop attack mismatch on square " << index << std::endl;
+        failed = true;
+      }
+
+      if (chess::rook_attack_board(occupied, square) !=
+          chess::rook_ray_attack_board(occupied, square)) {
+        std::cerr << "Rook attack mismatch on square " << index << std::endl;
+        failed = true;
+      }
+
+      if (chess::queen_attack_board(occupied, square) !=
+          chess::queen_ray_attack_board(occupied, square)) {
+        std::cerr << "Queen attack mismatch on square " << index << std::endl;
+        failed = true;
+      }
+
+      if (failed) {
+        return failed;
+      }
+    }
+  }
+
+  return failed;
+}
+
+bool test_slider_blockers() {
+  bool failed = false;
+
+  // Rook on d4 blocked on d6 and f4. Blockers are included in the attack set.
+  {
+    auto occupied = chess::Bitboard(0);
+    occupied.set(chess::Square(3, 5));
+    occupied.set(chess::Square(5, 3));
+    auto attacked = chess::rook_attack_board(occupied, chess::Square(3, 3));
+    if (attacked.count() != 10 || !attacked.occupied(chess::Square(3, 5)) ||
+        attacked.occupied(chess::Square(3, 6)) ||
+        !attacked.occupied(chess::Square(5, 3)) ||
+        attacked.occupied(chess::Square(6, 3))) {
+      failed = true;
+    }
+  }
+
+  // Bishop in the corner of an empty board.
+  {
+    auto attacked = chess::bishop_attack_board(0, chess::Square(7, 7));
+    if (attacked.count() != 7 || !attacked.occupied(chess::Square(0, 0))) {
+      failed = true;
+    }
+  }
+
+  return failed;
+}
+
+// Attacks of the piece on |square|, computed forwards from the piece.
+chess::Bitboard piece_attacks(const chess::Board &board, chess::Square square) {
+  const auto side = board.square_occupied(chess::kSideWhite, square)
+                        ? chess::kSideWhite
+                        : chess::kSideBlack;
+  const auto occupied = board.occupied();
+  switch (board.piece_type_at(square)) {
+  case chess::kPiecePawn:
+    return chess::pawn_attack_board(side, square);
+  case chess::kPieceKnight:
+    return chess::knight_attack_board(square);
+  case chess::kPieceBishop:
+    return chess::bishop_attack_board(occupied, square);
+  case chess::kPieceRook:
+    return chess::rook_attack_board(occupied, square);
+  case chess::kPieceQueen:
+    return chess::queen_attack_board(occupied, square);
+  default:
+    return chess::king_attack_board(square);
+  }
+}
+
+bool test_attackers_to() {
+  bool failed = false;
+
+  const char *fens[] = {
+      "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+      "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+      "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+  };
+
+  for (auto fen : fens) {
+    const auto board = chess::Board::from_fen(fen);
+    for (auto index = 0; index < 64; index++) {
+      const auto square = chess::Square(index);
+      chess::Bitboard expected;
+      chess::BitboardIterator piece_iter(board.occupied());
+      while (piece_iter.has_data()) {
+        const auto from = piece_iter.next();
+        if (piece_attacks(board, from).occupied(square)) {
+          expected.set(from);
+        }
+      }
+
+      if (board.attackers_to(square) != expected) {
+        std::cerr << "Attackers of square " << index << " wrong in " << fen
+                  << std::endl;
+        failed = true;
+      }
+    }
+  }
+
+  return failed;
+}
+
+int main() {
+  bool failed = false;
+
+  if (test_slider_attacks()) {
+    std::cerr << "Slider attack table test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_slider_blockers()) {
+    std::cerr << "Slider blocker test failed" << std::endl;
+    failed = true;
+  }
+
+  if (test_attackers_to()) {
+    std::cerr << "Attackers test failed" << std::endl;
+    failed = true;
+  }
+
+  return failed;
+}